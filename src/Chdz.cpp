@@ -24,6 +24,7 @@
  *   2色:  128 bytes/行 (8 px/byte) 行後部96バイトは不使用
  */
 #include "Chdz.hpp"
+#include "Prof.hpp"
 #include <cstring>
 
 namespace Chdz
@@ -39,17 +40,17 @@ static uint32_t MakePaletteEntry(uint8_t idx)
   return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | (0xFFu << 24);
 }
 
-// RGB121 パレット
+// RGB121 パレット (複数の System から同時に描画してもよいよう、初期化は一度だけ)
+struct Palette
+{
+  uint32_t entry[16];
+  Palette() { for (int i = 0; i < 16; i++) entry[i] = MakePaletteEntry((uint8_t)i); }
+};
+
 static const uint32_t* GetPalette()
 {
-  static uint32_t palette[16];
-  static bool initialized = false;
-  if (!initialized)
-  {
-    for (int i = 0; i < 16; i++) palette[i] = MakePaletteEntry((uint8_t)i);
-    initialized = true;
-  }
-  return palette;
+  static const Palette palette;
+  return palette.entry;
 }
 
 // ---------------------------------------------------------------
@@ -172,6 +173,7 @@ void Write(State& chdz, uint16_t addr, uint8_t val)
 // ---------------------------------------------------------------
 void RenderFrame(const State& chdz, uint32_t* pixels)
 {
+  FXT_PROF_ZONE(RENDER);
   // カラーパレット
   const uint32_t* palette = GetPalette();
 
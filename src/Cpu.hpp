@@ -0,0 +1,197 @@
+/* src/Cpu.hpp - CPUコアの切り替え層
+ *
+ * FXT_CPU_VREMU を定義しなければ W65c02.hpp のテンプレート実装を FxT-65 のバスに束縛したもの。
+ * RAM・ROM アクセスはインライン展開され、I/O だけ BusRead / BusWrite を呼ぶ。
+ * FXT_CPU_VREMU を定義すると従来の vrEmu6502 (リファレンス) を使う (Makefile の既定)。
+ */
+#pragma once
+#include <cstdint>
+
+#include "FxtSystem.hpp"
+#if FXT_JIT
+#include "Jit.hpp"
+#endif
+#if !FXT_CPU_VREMU
+#include "Trace.hpp"
+#endif
+#if FXT_ROM_AOT
+#include "RomAot.hpp"
+#endif
+
+namespace Fxt
+{
+namespace Cpu
+{
+  // レジスタ一覧 (表示用)
+  struct Regs
+  {
+    uint16_t pc;
+    uint8_t  a, x, y, sp, p;
+  };
+
+#if FXT_CPU_VREMU
+
+  static constexpr uint8_t OPC_STP = 0xDB; // W65C02 STP命令
+
+  // 生成してリセット
+  inline void Init(System& sys)
+  {
+    if (sys.cpu) vrEmu6502Destroy(sys.cpu); // ハードリセットでは作り直す
+    sys.cpu = vrEmu6502New(CPU_W65C02, System::BridgeRead, System::BridgeWrite, &sys);
+
+    // RAM・ROM はページテーブルで直接アクセスさせ、I/O だけブリッジ関数を通す
+    for (int page = 0x00; page < 0x80; page++)
+      vrEmu6502MapPage(sys.cpu, (uint8_t)page, &sys.ram[page << 8], &sys.ram[page << 8]);
+    for (int page = 0xF0; page <= 0xFF; page++)
+      vrEmu6502MapPage(sys.cpu, (uint8_t)page, &sys.rom[(page & 0x0F) << 8], nullptr);
+    vrEmu6502Reset(sys.cpu);
+    sys.irqPin = vrEmu6502Int(sys.cpu);
+    sys.nmiPin = vrEmu6502Nmi(sys.cpu);
+  }
+
+  // 解放
+  inline void Destroy(System& sys)
+  {
+    if (sys.cpu) vrEmu6502Destroy(sys.cpu);
+    sys.cpu    = nullptr;
+    sys.irqPin = nullptr;
+    sys.nmiPin = nullptr;
+  }
+
+  inline void    Reset(System& sys)     { vrEmu6502Reset(sys.cpu); }
+  inline void    Tick(System& sys)      { vrEmu6502Tick(sys.cpu); }
+  inline uint8_t InstCycle(System& sys) { return vrEmu6502InstCycle(sys.cpu); }
+
+  // 連続実行 (vrEmu6502 は1命令ずつ)
+  inline void Run(System& sys, uint64_t) { sys.sched.now += vrEmu6502InstCycle(sys.cpu); }
+
+  inline void SetIrq(System& sys, bool on)
+  {
+    if (sys.irqPin) *sys.irqPin = on ? IntRequested : IntCleared;
+  }
+  inline void SetNmi(System& sys, bool on)
+  {
+    if (sys.nmiPin) *sys.nmiPin = on ? IntRequested : IntCleared;
+  }
+
+  inline bool     IsStopped(const System& sys) { return vrEmu6502GetCurrentOpcode(sys.cpu) == OPC_STP; }
+  inline uint16_t GetPC(const System& sys)     { return vrEmu6502GetPC(sys.cpu); }
+
+  inline Regs GetRegs(const System& sys)
+  {
+    Regs r;
+    r.pc = vrEmu6502GetPC(sys.cpu);
+    r.a  = vrEmu6502GetAcc(sys.cpu);
+    r.x  = vrEmu6502GetX(sys.cpu);
+    r.y  = vrEmu6502GetY(sys.cpu);
+    r.sp = vrEmu6502GetStackPointer(sys.cpu);
+    r.p  = vrEmu6502GetStatus(sys.cpu);
+    return r;
+  }
+
+#else
+
+  // FxT-65 のバス (W65c02 のテンプレート引数)
+  struct Bus
+  {
+    System& sys;
+
+    uint8_t Read(uint16_t addr)
+    {
+      if (addr < 0x8000)  return sys.ram[addr];
+      if (addr >= 0xF000) return sys.rom[addr & 0x0FFF];
+      return BusRead(sys, addr);
+    }
+
+    uint8_t Fetch(uint16_t addr) { return Read(addr); }
+
+    bool PureRead(uint16_t addr)
+    {
+      if (addr < 0x8000 || addr >= 0xF000) return true;
+      return BusPureRead(sys, addr);
+    }
+
+    void Write(uint16_t addr, uint8_t val)
+    {
+      if (addr < 0x8000)
+      {
+        sys.ram[addr] = val;
+#if FXT_JIT
+        if (sys.jit_code[addr]) Jit::OnWrite(sys, addr);
+#endif
+        if (sys.trace_page[addr >> 8]) Trace::OnWrite(sys, addr);
+        return;
+      }
+      BusWrite(sys, addr, val);
+    }
+  };
+
+  inline void Reset(System& sys)
+  {
+    Bus bus{sys};
+    W65c02::Reset(sys.cpu, bus);
+  }
+
+  inline void Init(System& sys) { Reset(sys); }
+  inline void Destroy(System&) {}
+
+  inline void Tick(System& sys)
+  {
+    Bus bus{sys};
+    W65c02::Tick(sys.cpu, bus);
+  }
+
+  inline uint8_t InstCycle(System& sys)
+  {
+    Bus bus{sys};
+    return W65c02::InstCycle(sys.cpu, bus);
+  }
+
+  // 連続実行: target に達するか、期限の来たイベントを越えるか、STP で戻る
+  inline void Run(System& sys, uint64_t target)
+  {
+#if FXT_JIT
+    if (sys.jit) { Jit::Run(sys, target); return; }
+#endif
+    if (sys.trace) { Trace::Run(sys, target); return; }
+    Bus bus{sys};
+#if FXT_ROM_AOT
+    if (sys.rom_aot)
+    {
+      // ROM 内は事前変換コード、それ以外はインタプリタ (ROM に入ったら戻る)
+      Sched::State& s = sys.sched;
+      do
+      {
+        if (sys.cpu.pc >= 0xF000 && RomAot::Run(sys, target)) continue;
+        W65c02::Run(sys.cpu, bus, s.now, target, s.next_due, 0xF000);
+      }
+      while (!sys.cpu.stp && s.now < target && s.now <= s.next_due);
+      return;
+    }
+#endif
+    W65c02::Run(sys.cpu, bus, sys.sched.now, target, sys.sched.next_due);
+  }
+
+  inline void SetIrq(System& sys, bool on) { sys.cpu.irq = on; }
+  inline void SetNmi(System& sys, bool on) { sys.cpu.nmi = on; }
+
+  inline bool     IsStopped(const System& sys) { return sys.cpu.stp; }
+  inline uint16_t GetPC(const System& sys)     { return sys.cpu.pc; }
+
+  inline Regs GetRegs(const System& sys)
+  {
+    const W65c02::State& c = sys.cpu;
+    Regs r;
+    r.pc = c.pc;
+    r.a  = c.a;
+    r.x  = c.x;
+    r.y  = c.y;
+    r.sp = c.sp;
+    r.p  = c.p;
+    return r;
+  }
+
+#endif
+
+}
+}
@@ -0,0 +1,169 @@
+/* src/EmuThread.cpp - エミュレーション専用スレッド */
+#include "EmuThread.hpp"
+
+#if FXT_EMU_THREAD
+#include "FxtSystem.hpp"
+#include "Ps2.hpp"
+#include "Prof.hpp"
+
+#include <chrono>
+#include <functional> // std::ref
+
+namespace Fxt
+{
+namespace EmuThread
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // これ以上遅れたら追いつこうとしない [スライス]
+  static constexpr int MAX_LAG = 5;
+
+  // 入力を System に反映
+  static void Apply(System& sys, const Input& in)
+  {
+    switch (in.type)
+    {
+      case Input::KEY_DOWN:   Ps2::KeyDown(sys, in.code); break;
+      case Input::KEY_UP:     Ps2::KeyUp(sys, in.code);   break;
+      case Input::UART:       UartInput(sys, in.code);    break;
+      case Input::RESET:      Cpu::Reset(sys);            break;
+      case Input::HARD_RESET: Init(sys);                  break;
+    }
+  }
+
+  static float Ms(Clock::duration d)
+  {
+    return std::chrono::duration<float, std::milli>(d).count();
+  }
+
+  // back に描画して最新として公開し、空いた添字を次の back にする
+  static void Publish(State& emu, float run_ms)
+  {
+    const System& sys = *emu.sys;
+    Frame& f = emu.frames[emu.back];
+    Clock::time_point t0 = Clock::now();
+    Chdz::RenderFrame(sys.chdz, f.pixels);
+    f.render_ms    = Ms(Clock::now() - t0);
+    f.run_ms       = run_ms;
+    f.sd_sectors   = sys.sd.sectors_read + sys.sd.sectors_written;
+    f.target_hz    = (double)sys.cfg.cpu_hz * sys.cfg.sim_speed;
+    f.regs         = Cpu::GetRegs(sys);
+    f.sd_mounted   = sys.sd.image_fp != nullptr;
+    f.uart_rx_full = (sys.uart_status & 0b00001000) != 0;
+    f.cycles       = sys.sched.now;
+    f.inputs       = emu.inputs;
+    emu.back = emu.latest.exchange(emu.back | State::FRESH, std::memory_order_acq_rel) & 3;
+  }
+
+  static void Main(State& emu)
+  {
+    System& sys = *emu.sys;
+#if FXT_PROF
+    Prof::SetThreadName("emu");
+#endif
+    const Clock::duration period =
+      std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / EmulatorConfig::HOST_FPS;
+    Clock::time_point next = Clock::now();
+
+    while (emu.running.load(std::memory_order_acquire))
+    {
+      // 一時停止要求: 描画スレッドが System を触り終えるまで待つ
+      if (emu.pause_req.load(std::memory_order_acquire))
+      {
+        emu.paused.store(true, std::memory_order_release);
+        while (emu.pause_req.load(std::memory_order_acquire))
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        emu.paused.store(false, std::memory_order_release);
+        next = Clock::now();
+        continue;
+      }
+
+      Input in;
+      while (emu.input.Pop(in))
+      {
+        Apply(sys, in);
+        emu.inputs++;
+      }
+
+      // 実行 (周辺機器・音声サンプリングはイベントで追従)
+      Clock::time_point t0 = Clock::now();
+      RunCycles(sys, (uint64_t)sys.cfg.ticks_per_frame());
+      for (int i = 0; i < sys.audio_count; i++)
+        emu.audio.Push(sys.audio_buf[i]);
+      sys.audio_count = 0;
+
+      Publish(emu, Ms(Clock::now() - t0));
+
+      // 壁時計に合わせる
+      next += period;
+      Clock::time_point now = Clock::now();
+      if (now > next + period * MAX_LAG)
+        next = now;
+      else
+        std::this_thread::sleep_until(next);
+    }
+  }
+
+  void Start(State& emu, System& sys)
+  {
+    if (emu.running.load()) return;
+    emu.sys = &sys;
+    emu.running.store(true, std::memory_order_release);
+    emu.thread = std::thread(Main, std::ref(emu));
+  }
+
+  void Stop(State& emu)
+  {
+    if (!emu.running.load()) return;
+    emu.running.store(false, std::memory_order_release);
+    emu.pause_req.store(false, std::memory_order_release);
+    emu.thread.join();
+  }
+
+  void Pause(State& emu)
+  {
+    if (!emu.running.load()) return;
+    emu.pause_req.store(true, std::memory_order_release);
+    while (!emu.paused.load(std::memory_order_acquire))
+      std::this_thread::yield();
+  }
+
+  void Resume(State& emu)
+  {
+    if (!emu.running.load()) return;
+    emu.pause_req.store(false, std::memory_order_release);
+    while (emu.paused.load(std::memory_order_acquire))
+      std::this_thread::yield();
+  }
+
+  bool Send(State& emu, Input::Type type, int code)
+  {
+    Input in;
+    in.type = type;
+    in.code = code;
+    return emu.input.Push(in);
+  }
+
+  const Frame& Acquire(State& emu)
+  {
+    if (emu.latest.load(std::memory_order_acquire) & State::FRESH)
+      emu.front = emu.latest.exchange(emu.front, std::memory_order_acq_rel) & 3;
+    return emu.frames[emu.front];
+  }
+
+  int ReadAudio(State& emu, float* out, int count)
+  {
+    int n = 0;
+    while (n < count && emu.audio.Pop(out[n])) n++;
+    return n;
+  }
+
+  int AudioQueued(const State& emu)
+  {
+    return (int)(emu.audio.head.load(std::memory_order_relaxed) -
+                 emu.audio.tail.load(std::memory_order_relaxed));
+  }
+
+} // namespace EmuThread
+} // namespace Fxt
+#endif // FXT_EMU_THREAD
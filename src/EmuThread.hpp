@@ -0,0 +1,135 @@
+/* src/EmuThread.hpp - エミュレーション専用スレッド
+ *
+ * System の実行を sokol の frame_cb から切り離し、専用スレッドで壁時計に合わせて進める。
+ *   - 1スライス = cfg.ticks_per_frame() サイクルを HOST_FPS の周期で実行する
+ *     (大きく遅れたときは追いつこうとせず、基準時刻を取り直す)
+ *   - 描画済みのフレームバッファとステータスバー用の状態はトリプルバッファで描画スレッドへ渡す
+ *   - 音声サンプルは SPSC リングで sokol_audio のストリームコールバックへ渡す
+ *   - キー入力・UART 入力・リセットは SPSC キューでエミュレーションスレッドへ渡す
+ * いずれも生産者・消費者が1スレッドずつなのでロックを使わない。
+ * SD イメージの差し替えなど、描画スレッドが System を直接触る処理は Pause / Resume で挟む。
+ *
+ * std::thread の使えない環境 (Emscripten、win32 スレッドモデルの MinGW) では
+ * FXT_EMU_THREAD=0 となり、従来どおり frame_cb の中で実行する。
+ */
+#pragma once
+#include <cstdint>
+
+#ifndef FXT_EMU_THREAD
+#  if defined(__EMSCRIPTEN__)
+#    define FXT_EMU_THREAD 0
+#  elif defined(__GLIBCXX__) && !defined(_GLIBCXX_HAS_GTHREADS)
+#    define FXT_EMU_THREAD 0
+#  else
+#    define FXT_EMU_THREAD 1
+#  endif
+#endif
+
+#if FXT_EMU_THREAD
+#include <atomic>
+#include <thread>
+
+#include "Chdz.hpp"
+#include "Cpu.hpp"
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace EmuThread
+  {
+    // 単一生産者・単一消費者のリングバッファ (SIZE は2のべき)
+    template <class T, uint32_t SIZE>
+    struct Ring
+    {
+      T buf[SIZE];
+      std::atomic<uint32_t> head{0}; // 次に書く位置 (生産者だけが更新)
+      std::atomic<uint32_t> tail{0}; // 次に読む位置 (消費者だけが更新)
+
+      // 満杯なら false (捨てる)
+      bool Push(const T& v)
+      {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == SIZE) return false;
+        buf[h & (SIZE - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+      }
+
+      // 空なら false
+      bool Pop(T& v)
+      {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        v = buf[t & (SIZE - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+      }
+    };
+
+    // 描画スレッド → エミュレーションスレッドの入力
+    struct Input
+    {
+      enum Type : uint8_t { KEY_DOWN, KEY_UP, UART, RESET, HARD_RESET };
+      Type type;
+      int  code; // KEY_*: sapp キーコード / UART: 文字
+    };
+
+    // エミュレーションスレッド → 描画スレッドの1フレーム
+    struct Frame
+    {
+      uint32_t  pixels[Chdz::DISPLAY_W * Chdz::DISPLAY_H];
+      Cpu::Regs regs;
+      bool      sd_mounted;
+      bool      uart_rx_full; // UART 受信データが未読
+      uint64_t  cycles;       // sched.now
+      uint32_t  inputs;       // ここまでに処理した入力の数
+      // 性能モニタ用
+      float     run_ms;       // このスライスの RunCycles
+      float     render_ms;    // このフレームの Chdz::RenderFrame
+      uint64_t  sd_sectors;   // SD カードの読み書きセクタ数 (累計)
+      double    target_hz;    // 目標のエミュレーション速度
+    };
+
+    struct State
+    {
+      System*     sys = nullptr;
+      std::thread thread;
+      std::atomic<bool> running{false};
+      std::atomic<bool> pause_req{false};
+      std::atomic<bool> paused{false};
+
+      // トリプルバッファ: 書き込み中 (back)・最新 (latest)・表示中 (front) を添字で入れ替える
+      static constexpr uint8_t FRESH = 0x4; // latest が未取得
+      Frame   frames[3];
+      std::atomic<uint8_t> latest{1};
+      uint8_t back  = 0; // エミュレーションスレッド専用
+      uint8_t front = 2; // 描画スレッド専用
+
+      Ring<float, 4096> audio;
+      Ring<Input, 256>  input;
+      uint32_t inputs = 0; // 処理した入力の数 (エミュレーションスレッド専用)
+    };
+
+    // 開始・停止 (描画スレッドから呼ぶ)
+    void Start(State& emu, System& sys);
+    void Stop(State& emu);
+
+    // スライスの切れ目で止めて待つ / 再開する (間は描画スレッドが System を触ってよい)
+    void Pause(State& emu);
+    void Resume(State& emu);
+
+    // 入力を送る。キューが満杯なら false
+    bool Send(State& emu, Input::Type type, int code = 0);
+
+    // 最新のフレーム (新しいものがなければ前回と同じもの)。描画スレッドから呼ぶ
+    const Frame& Acquire(State& emu);
+
+    // 音声サンプルを count 個まで読み出し、読めた数を返す。音声スレッドから呼ぶ
+    int ReadAudio(State& emu, float* out, int count);
+    // 再生待ちの音声サンプル数 (どのスレッドからでもよい。目安の値)
+    int AudioQueued(const State& emu);
+  }
+}
+#endif // FXT_EMU_THREAD
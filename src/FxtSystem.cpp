@@ -1,46 +1,79 @@
 /* src/FxtSystem.cpp */
 #include "FxtSystem.hpp"
+#include "Cpu.hpp"
+#if FXT_ROM_AOT
+#include "RomAot.hpp"
+#endif
 #include "Ps2.hpp"
+#include "Prof.hpp"
 #include <cstdio>
 
 namespace Fxt
 {
-  // インスタンスのポインタ
-  System* System::s_instance = nullptr;
+  static constexpr float INT16_FULL_SCALE = 32768.0f; // int16_t→float 正規化係数
 
+#if FXT_CPU_VREMU
   // Cライブラリに渡すためのブリッジ関数
-  uint8_t System::BridgeRead(uint16_t addr, bool isDbg)
+  uint8_t System::BridgeRead(void* ctx, uint16_t addr, bool isDbg)
   {
-    return BusRead(*s_instance, addr);
+    return BusRead(*static_cast<System*>(ctx), addr);
   }
 
-  void System::BridgeWrite(uint16_t addr, uint8_t val)
+  void System::BridgeWrite(void* ctx, uint16_t addr, uint8_t val)
   {
-    BusWrite(*s_instance, addr, val);
+    BusWrite(*static_cast<System*>(ctx), addr, val);
   }
+#endif
 
   // コンストラクタ
   System::System() {}
 
   // デストラクタ
-  System::~System() {}
+  System::~System()
+  {
+#if FXT_JIT
+    Jit::Shutdown(*this);
+#endif
+#if !FXT_CPU_VREMU
+    Trace::Shutdown(*this);
+#endif
+    Hotspot::Stop(*this);
+#if FXT_OPSTATS
+    OpStats::Stop(*this);
+#endif
+    Cpu::Destroy(*this);
+    Psg::Shutdown(psg);
+    Sd::UnmountImg(*this);
+  }
 
   // 周辺機器の状態に応じて割り込み線を更新
   void UpdateIrq(System& sys)
   {
-    if (!sys.irqPin) return;
-
     // UART・VIAからの割り込み要求
     bool uart_irq = (sys.uart_status & 0b00001000); // RxReady
     bool via_irq  = (sys.via.reg_ifr & sys.via.reg_ier & 0x7F);
 
-    if (uart_irq || via_irq) *sys.irqPin = IntRequested;
-    else                     *sys.irqPin = IntCleared;
+    Cpu::SetIrq(sys, uart_irq || via_irq);
   }
 
   // ノンマスカブル割り込み操作
-  void RequestNmi(System& sys) { if (sys.nmiPin) *sys.nmiPin = IntRequested; }
-  void ClearNmi(System& sys) { if (sys.nmiPin) *sys.nmiPin = IntCleared; }
+  void RequestNmi(System& sys) { Cpu::SetNmi(sys, true); }
+  void ClearNmi(System& sys) { Cpu::SetNmi(sys, false); }
+
+  // UART 受信
+  void UartInput(System& sys, int ch)
+  {
+    if (ch == 0x7F) ch = 0x08; // DEL → BS
+    sys.uart_input_buffer = (uint8_t)ch;
+    sys.uart_status |= 0b00001000;
+    UpdateIrq(sys);
+    if (ch == ('N' - 0x40)) // Ctrl+N: NMI
+    {
+      RequestNmi(sys);
+      RunCycles(sys, 10);
+      ClearNmi(sys);
+    }
+  }
 
   // ROMロード 8KBのイメージファイルの後半4KBをROMに読み込む（実機準拠動作）
   bool LoadRom(System& sys, const std::string& filename)
@@ -60,14 +93,131 @@ namespace Fxt
     return true;
   }
 
+  // --- I/O ハンドラ ---
+
+  // UART ($E000 RX/TX, $E001 STATUS)
+  static uint8_t UartRead(System& sys, void*, uint16_t addr)
+  {
+    if (addr == 0xE000)
+    {
+      Cpu::SetIrq(sys, false);
+      sys.uart_status &= 0b11110111;
+      UpdateIrq(sys);
+      return sys.uart_input_buffer;
+    }
+    if (addr == 0xE001) return sys.uart_status;
+    return 0;
+  }
+
+  static void UartWrite(System& sys, void*, uint16_t addr, uint8_t val)
+  {
+    if (addr == 0xE000)
+    {
+      if (sys.uart_tx)
+      {
+        sys.uart_tx(sys, sys.uart_tx_ctx, val);
+        return;
+      }
+      putchar(val);
+      fflush(stdout);
+    }
+  }
+
+  // VIA ($E200-$E20F)
+  static uint8_t ViaRead(System& sys, void*, uint16_t addr)
+  {
+    FXT_PROF_ZONE(VIA);
+    return Via::Read(sys, addr);
+  }
+
+  static void ViaWrite(System& sys, void*, uint16_t addr, uint8_t val)
+  {
+    FXT_PROF_ZONE(VIA);
+    Via::Write(sys, addr, val);
+  }
+
+  // PSG (YMZ294) ($E400 アドレス, $E401 データ)
+  static uint8_t PsgRead(System&, void* ctx, uint16_t addr)
+  {
+    FXT_PROF_ZONE(PSG);
+    if (addr == 0xE401) return Psg::ReadData(*(Psg::State*)ctx);
+    return 0;
+  }
+
+  static void PsgWrite(System&, void* ctx, uint16_t addr, uint8_t val)
+  {
+    FXT_PROF_ZONE(PSG);
+    if (addr == 0xE400) Psg::WriteAddr(*(Psg::State*)ctx, val);
+    if (addr == 0xE401) Psg::WriteData(*(Psg::State*)ctx, val);
+  }
+
+  // Chiina-Dazzler CRTC ($E600-$E607, 書き込みのみ)
+  static void ChdzWrite(System&, void* ctx, uint16_t addr, uint8_t val)
+  {
+    if ((addr & 0x000F) < 8) Chdz::Write(*(Chdz::State*)ctx, addr, val);
+  }
+
+  // 次の音声サンプリングまでのサイクル数
+  // 毎サイクル audio_hz を加算し、cpu_hz に達したサイクルでサンプリングするのと等価
+  static int64_t AudioTicks(const System& sys)
+  {
+    int64_t need  = (int64_t)sys.cfg.cpu_hz - sys.audio_acc;
+    int64_t ticks = (need + sys.cfg.audio_hz - 1) / sys.cfg.audio_hz;
+    return ticks < 1 ? 1 : ticks;
+  }
+
+  // 次の音声サンプリングを登録 (from = 端数が未加算の最初のサイクル)
+  static void ScheduleAudio(System& sys, uint64_t from)
+  {
+    Sched::Schedule(sys.sched, Sched::EV_AUDIO, from + AudioTicks(sys) - 1);
+  }
+
   // システム初期化
   void Init(System& sys)
   {
-    System::s_instance = &sys;
-    sys.cpu = vrEmu6502New(CPU_W65C02, System::BridgeRead, System::BridgeWrite);
-    vrEmu6502Reset(sys.cpu);
-    sys.irqPin = vrEmu6502Int(sys.cpu);
-    sys.nmiPin = vrEmu6502Nmi(sys.cpu);
+    Cpu::Init(sys);
+#if FXT_JIT
+    // 確保できなければインタプリタのみで動かす
+    if (!sys.cfg.jit || !Jit::Init(sys)) Jit::Shutdown(sys);
+#endif
+#if !FXT_CPU_VREMU
+    if (sys.cfg.trace) Trace::Init(sys);
+    else               Trace::Shutdown(sys);
+#endif
+#if FXT_ROM_AOT
+    // 読み込んだ ROM が生成元と一致するときだけ使う
+    sys.rom_aot = sys.cfg.rom_aot && RomAot::Matches(sys);
+#endif
+
+    // I/O デバイス登録
+    MapIo(sys, 0xE000, 0x10, UartRead, UartWrite, nullptr);
+    MapIo(sys, 0xE200, 0x10, ViaRead,  ViaWrite,  &sys.via);
+    MapIo(sys, 0xE400, 0x10, PsgRead,  PsgWrite,  &sys.psg);
+    MapIo(sys, 0xE600, 0x10, nullptr,  ChdzWrite, &sys.chdz);
+    // ホットスポット計測中は登録し直したハンドラも数える
+    if (sys.hotspot) Hotspot::HookIo(sys);
+
+    // VBLANK は周期イベントとして常時登録
+    if (!Sched::IsPending(sys.sched, Sched::EV_VBLANK))
+      Sched::Schedule(sys.sched, Sched::EV_VBLANK,
+                      sys.sched.now + sys.cfg.vblank_period() - 1);
+    // 音声サンプリングも同様
+    if (sys.cfg.audio_hz > 0 && !Sched::IsPending(sys.sched, Sched::EV_AUDIO))
+      ScheduleAudio(sys, sys.sched.now);
+  }
+
+  // I/O デバイス登録
+  void MapIo(System& sys, uint16_t addr, uint16_t size,
+             Io::ReadFn read, Io::WriteFn write, void* ctx)
+  {
+    int first = (addr - Io::BASE) >> Io::SLOT_SHIFT;
+    int last  = (addr + size - 1 - Io::BASE) >> Io::SLOT_SHIFT;
+    for (int i = first; i <= last; i++)
+    {
+      sys.io[i].read  = read;
+      sys.io[i].write = write;
+      sys.io[i].ctx   = ctx;
+    }
   }
 
   // バス読み込み
@@ -75,66 +225,157 @@ namespace Fxt
   {
     // RAM
     if (addr < 0x8000) return sys.ram[addr];
-    // IO and ROM
-    if (addr >= 0xE000)
+    // ROM
+    if (addr >= 0xF000) return sys.rom[addr & 0x0FFF];
+    // I/O
+    if (addr >= Io::BASE)
     {
-      // I/O
-      // --- UART RX
-      if (addr == 0xE000)
-      {
-        if (sys.irqPin) *sys.irqPin = IntCleared;
-        sys.uart_status &= 0b11110111;
-        UpdateIrq(sys);
-        return sys.uart_input_buffer;
-      }
-      // --- UART STATUS
-      if (addr == 0xE001) return sys.uart_status;
-      // --- VIA
-      if (addr >= 0xE200 && addr <= 0xE20F) return Via::Read(sys, addr);
-      // --- PSG (YMZ294) データ読み出し
-      if (addr == 0xE401) return Psg::ReadData(sys.psg);
-      // ROM
-      if (addr >= 0xF000) return sys.rom[addr & 0x0FFF];
+      const Io::Slot& slot = sys.io[(addr - Io::BASE) >> Io::SLOT_SHIFT];
+      return slot.read ? slot.read(sys, slot.ctx, addr) : 0;
     }
     return 0;
   }
 
+  // 読み出しに副作用がなく、次のイベントまで値が変わらないか
+  // デバイスの状態はイベントと書き込みでしか変わらないので、読み出しで状態を変えるものと
+  // 時刻から値を求めるものだけを除く
+  bool BusPureRead(const System&, uint16_t addr)
+  {
+    if (addr < Io::BASE || addr >= 0xF000) return true;
+    // UART 受信データ (読むと受信フラグと割り込みをクリア)
+    if (addr == 0xE000) return false;
+    // VIA タイマカウンタ・シフトレジスタ
+    if ((addr & 0xFFF0) == 0xE200) return Via::IsPureRead(addr);
+    return true;
+  }
+
   // バス書き込み
   void BusWrite(System& sys, uint16_t addr, uint8_t val)
   {
     // RAM
-    if (addr < 0x8000) sys.ram[addr] = val;
-    // UART
-    if (addr == 0xE000)
+    if (addr < 0x8000)
     {
-      putchar(val);
-      fflush(stdout);
+      sys.ram[addr] = val;
+#if FXT_JIT
+      if (sys.jit_code[addr]) Jit::OnWrite(sys, addr);
+#endif
+#if !FXT_CPU_VREMU
+      if (sys.trace_page[addr >> 8]) Trace::OnWrite(sys, addr);
+#endif
+      return;
+    }
+    // I/O
+    if (addr >= Io::BASE && addr < 0xF000)
+    {
+      const Io::Slot& slot = sys.io[(addr - Io::BASE) >> Io::SLOT_SHIFT];
+      if (slot.write) slot.write(sys, slot.ctx, addr, val);
     }
-    // VIA
-    if (addr >= 0xE200 && addr <= 0xE20F) Via::Write(sys, addr, val);
-    // PSG (YMZ294)
-    if (addr == 0xE400) Psg::WriteAddr(sys.psg, val);
-    if (addr == 0xE401) Psg::WriteData(sys.psg, val);
-    // Chiina-Dazzler CRTC
-    if (addr >= 0xE600 && addr <= 0xE607) Chdz::Write(sys.chdz, addr, val);
   }
 
   // 1サイクル実行
+  // 周辺機器は毎サイクル駆動せず、期限に達したイベントだけを処理する
   void Tick(System& sys)
   {
-    vrEmu6502Tick(sys.cpu);
-    Via::Tick(sys);
-    Ps2::Tick(sys);
+    Cpu::Tick(sys);
+    if (sys.sched.now >= sys.sched.next_due) Sched::Dispatch(sys);
+    ++sys.sched.now;
+  }
+
+  // 命令単位で budget サイクル分実行
+  // 命令のサイクル数だけクロックを進め、その間に期限が来たイベントをまとめて処理する
+  // (CPUコアはバスアクセスを命令の先頭サイクルで行うため、1サイクルずつ回すのと結果は同じ)
+  // 停止理由:
+  //   BUDGET     目標サイクルに到達 (命令の超過分は次回の予算から差し引く)
+  //   STP        STP命令で停止 (CPUは止まったまま、周辺機器は目標サイクルまで進める)
+  //   BREAKPOINT ブレークポイントのアドレスに到達 (その命令は未実行)
+  //              そこから再開する呼び出しでは、最初の1命令だけブレークポイントを無視して実行する
+  StopReason RunCycles(System& sys, uint64_t budget)
+  {
+    FXT_PROF_ZONE(CPU, &sys);
+    Sched::State& s = sys.sched;
+    uint64_t target = (sys.run_target < s.now ? sys.run_target : s.now) + budget;
+    sys.run_target = target;
 
-    // VBLANK (VIA CA2 立ち下がりエッジ) 生成
-    if (++sys.vblank_cnt >= sys.cfg.vblank_period())
+    bool resume = sys.bp_resume;
+    sys.bp_resume = false;
+    while (s.now < target)
     {
-      sys.vblank_cnt = 0;
-      // PCR bits[3:1] = 001 の場合のみ CA2 を立ち下がりエッジ割り込みとして扱う
-      // IFR bit0 = CA2 フラグをセット
-      sys.via.reg_ifr |= 0x01;
-      UpdateIrq(sys);
+      if (sys.bp_count && !resume)
+      {
+        uint16_t pc = Cpu::GetPC(sys);
+        if (sys.bp_map[pc >> 3] & (1 << (pc & 7)))
+        {
+          sys.bp_resume = true;
+          return StopReason::BREAKPOINT;
+        }
+      }
+      resume = false;
+
+      // 計測中・ブレークポイントがあれば1命令ずつ、なければイベント期限まで連続実行
+#if FXT_OPSTATS
+      if (sys.opstats)       s.now += OpStats::Step(sys);
+      else
+#endif
+      if (sys.hotspot)       s.now += Hotspot::Step(sys);
+      else if (sys.bp_count) s.now += Cpu::InstCycle(sys);
+      else                   Cpu::Run(sys, target);
+
+      // 最後の命令の最終サイクルまでに期限が来たイベントを処理
+      if (s.now > s.next_due)
+      {
+        --s.now;
+        Sched::Dispatch(sys);
+        ++s.now;
+      }
+
+      if (Cpu::IsStopped(sys))
+      {
+        if (s.now < target)
+        {
+          s.now = target - 1;
+          if (s.now >= s.next_due) Sched::Dispatch(sys);
+          s.now = target;
+        }
+        return StopReason::STP;
+      }
     }
+    return StopReason::BUDGET;
+  }
+
+  // ブレークポイント設定・解除
+  void SetBreakpoint(System& sys, uint16_t addr, bool enable)
+  {
+    uint8_t bit = 1 << (addr & 7);
+    bool    set = (sys.bp_map[addr >> 3] & bit) != 0;
+    if (enable == set) return;
+
+    sys.bp_map[addr >> 3] ^= bit;
+    sys.bp_count += enable ? 1 : -1;
+  }
+
+  // VBLANK (VIA CA2 立ち下がりエッジ) 生成
+  void OnVblank(System& sys, uint64_t cycle)
+  {
+    // PCR bits[3:1] = 001 の場合のみ CA2 を立ち下がりエッジ割り込みとして扱う
+    // IFR bit0 = CA2 フラグをセット
+    sys.via.reg_ifr |= 0x01;
+    UpdateIrq(sys);
+
+    Sched::Schedule(sys.sched, Sched::EV_VBLANK, cycle + sys.cfg.vblank_period());
+  }
+
+  // 音声サンプリング
+  void OnAudio(System& sys, uint64_t cycle)
+  {
+    // カウンタをリセットするが端数を保存
+    int64_t ticks = AudioTicks(sys);
+    sys.audio_acc = (int)(sys.audio_acc + ticks * sys.cfg.audio_hz - sys.cfg.cpu_hz);
+
+    // PSG出力信号レベル（16bit int）を正規化してバッファへ
+    if (sys.audio_count < System::AUDIO_BUF_SIZE)
+      sys.audio_buf[sys.audio_count++] = Psg::Calc(sys.psg) / INT16_FULL_SCALE;
+
+    ScheduleAudio(sys, cycle + 1);
   }
 
 }
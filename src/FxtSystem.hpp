@@ -10,8 +10,20 @@
 #include "Chdz.hpp"
 #include "Ps2.hpp"
 #include "Psg.hpp"
+#include "Scheduler.hpp"
+#include "Hotspot.hpp"
+#include "OpStats.hpp"
+#include "Symbols.hpp"
 
+#if FXT_CPU_VREMU
 #include "lib/vrEmu6502.h"
+#else
+#include "W65c02.hpp"
+#include "Trace.hpp"
+#endif
+#if FXT_JIT
+#include "Jit.hpp"
+#endif
 
 namespace Fxt
 {
@@ -28,6 +40,16 @@ namespace Fxt
     static constexpr int PS2_CLK_HZ = 12000; // PS/2バスクロック (~12kHz)
     static constexpr int HOST_FPS   = 60;     // Sokolフレームレート
 
+    // 音声サンプリング周波数 [Hz] (0=サンプリングしない)
+    int audio_hz = 0;
+
+    // JIT を使う (JIT=1 ビルドのみ有効)
+    bool jit = true;
+    // ROM の事前変換コードを使う (ROM_AOT=1 ビルドのみ有効)
+    bool rom_aot = true;
+    // デコード済み命令のトレースキャッシュを使う (native コアのみ有効)
+    bool trace = false;
+
     // VBLANK周期 [CPUサイクル]
     int vblank_period()   const { return cpu_hz / VBLANK_HZ; }
     // PS/2クロック半周期 [CPUサイクル]
@@ -39,19 +61,46 @@ namespace Fxt
     }
   };
 
+  // I/O デコードテーブル ($E000-$EFFF を16バイト単位のスロットに分割)
+  namespace Io
+  {
+    static constexpr uint16_t BASE       = 0xE000;
+    static constexpr int      SLOT_SHIFT = 4;                     // 16バイト/スロット
+    static constexpr int      SLOT_COUNT = 0x1000 >> SLOT_SHIFT;  // 256スロット
+
+    // ハンドラ (ctx = 登録時に渡したデバイス状態)
+    typedef uint8_t (*ReadFn)(System& sys, void* ctx, uint16_t addr);
+    typedef void    (*WriteFn)(System& sys, void* ctx, uint16_t addr, uint8_t val);
+
+    struct Slot
+    {
+      ReadFn  read  = nullptr; // nullptr = 読み出しは0
+      WriteFn write = nullptr; // nullptr = 書き込みは無視
+      void*   ctx   = nullptr;
+    };
+  }
+
+  // RunCycles の停止理由
+  enum class StopReason { BUDGET, STP, BREAKPOINT };
+
   struct System
   {
-    // インスタンスのポインタ
-    static System* s_instance;
+    // 音声サンプルバッファサイズ [サンプル]
+    static constexpr int AUDIO_BUF_SIZE = 2048;
 
-    // Cライブラリに渡すためのブリッジ関数
-    static uint8_t BridgeRead(uint16_t addr, bool isDbg);
-    static void BridgeWrite(uint16_t addr, uint8_t val);
+#if FXT_CPU_VREMU
+    // Cライブラリに渡すためのブリッジ関数 (ctx = この System)
+    static uint8_t BridgeRead(void* ctx, uint16_t addr, bool isDbg);
+    static void BridgeWrite(void* ctx, uint16_t addr, uint8_t val);
 
     // CPU
     VrEmu6502* cpu = nullptr;
     vrEmu6502Interrupt* irqPin = nullptr;
     vrEmu6502Interrupt* nmiPin = nullptr;
+#else
+    // CPU (操作は Cpu.hpp 経由)
+    W65c02::State cpu;
+#endif
 
     // メモリ
     uint8_t ram[0x8000];
@@ -60,6 +109,9 @@ namespace Fxt
     // UART
     uint8_t uart_input_buffer = 0;
     uint8_t uart_status = 0;
+    // UART 送信先 (nullptr なら標準出力へ1文字ずつ書いてフラッシュする)
+    void (*uart_tx)(System& sys, void* ctx, uint8_t ch) = nullptr;
+    void* uart_tx_ctx = nullptr;
 
     // VIA
     Via::State via;
@@ -79,13 +131,63 @@ namespace Fxt
     // エミュレータ設定
     EmulatorConfig cfg;
 
-    // VBLANK (VIA CA2) 生成用カウンタ
-    int vblank_cnt = 0;
+    // I/O デコードテーブル
+    Io::Slot io[Io::SLOT_COUNT];
+
+    // 周辺機器イベントスケジューラ (サイクルクロック)
+    Sched::State sched;
+    // RunCycles の実行目標サイクル (命令の超過分を次回に繰り越す)
+    uint64_t run_target = 0;
+
+    // 音声サンプル (フロントエンドが取り出して再生する)
+    int   audio_acc = 0;                 // サンプリング周期の端数
+    int   audio_count = 0;               // バッファ内のサンプル数
+    float audio_buf[AUDIO_BUF_SIZE];
+
+    // ブレークポイント (アドレスごとのビットマップ)
+    uint8_t bp_map[0x10000 / 8] = {};
+    int     bp_count = 0;
+    // 直前の RunCycles がブレークポイントで止まった (次の呼び出しの最初の1命令はブレークポイントを見ない)
+    bool    bp_resume = false;
+
+    // ホットスポット計測のカウンタ (nullptr = 計測しない)
+    Hotspot::State* hotspot = nullptr;
+
+#if FXT_OPSTATS
+    // オペコード統計のカウンタ (nullptr = 計測しない)
+    OpStats::State* opstats = nullptr;
+#endif
+
+    // ゲストのシンボル表 (プロファイラ・ステータスバーの表示用。起動前に読み込む)
+    Symbols::Table symbols;
+
+#if !FXT_CPU_VREMU
+    // トレースキャッシュ (nullptr = 使わない)
+    Trace::Cache* trace = nullptr;
+    // RAM の各ページにトレースが掛かっているか (0以外なら書き込み時に Trace::OnWrite)
+    uint8_t trace_page[0x80] = {};
+#endif
+
+#if FXT_ROM_AOT
+    // ROM の事前変換コードを使うか (Init で生成元の ROM と照合して決める)
+    bool rom_aot = false;
+#endif
+
+#if FXT_JIT
+    // JIT の変換キャッシュ (nullptr = インタプリタのみ)
+    Jit::State* jit = nullptr;
+    // RAM の各バイトが変換済み命令か (0以外なら書き込み時に Jit::OnWrite)
+    uint8_t jit_code[0x8000] = {};
+#endif
 
     // コンストラクタ
     System();
-    // デストラクタ
+    // デストラクタ (CPU・PSG・SD イメージ・変換キャッシュを解放する)
     ~System();
+
+    // 資源を持つのでコピーしない (インスタンスごとに独立して生成する)
+    System(const System&) = delete;
+    System& operator=(const System&) = delete;
   };
 
   // 操作関数
@@ -96,13 +198,27 @@ namespace Fxt
   void Init(System& sys);
   // 1サイクル実行
   void Tick(System& sys);
+  // 命令単位で budget サイクル分実行 (停止理由を返す)
+  StopReason RunCycles(System& sys, uint64_t budget);
+  // ブレークポイント設定・解除
+  void SetBreakpoint(System& sys, uint16_t addr, bool enable);
+  // VBLANK・音声サンプリングイベント (スケジューラから呼ばれる)
+  void OnVblank(System& sys, uint64_t cycle);
+  void OnAudio(System& sys, uint64_t cycle);
+  // I/O デバイス登録 (addr から size バイトを含むスロットにハンドラを割り当て)
+  void MapIo(System& sys, uint16_t addr, uint16_t size,
+             Io::ReadFn read, Io::WriteFn write, void* ctx);
   // バス読み書き
   uint8_t BusRead(System& sys, uint16_t addr);
   void BusWrite(System& sys, uint16_t addr, uint8_t val);
+  // 読み出しに副作用がなく、次のイベントまで値が変わらないか (待機ループの検出用)
+  bool BusPureRead(const System& sys, uint16_t addr);
   // 割り込み操作
   void UpdateIrq(System& sys);
   void RequestNmi(System& sys);
   void ClearNmi(System& sys);
+  // UART 受信 (端末・キー入力から1文字。DEL は BS に変換、Ctrl+N は NMI を短く入れる)
+  void UartInput(System& sys, int ch);
 
 }
 
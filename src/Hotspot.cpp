@@ -0,0 +1,355 @@
+/* src/Hotspot.cpp - ゲストコードのホットスポット計測 */
+#include "Hotspot.hpp"
+#include "FxtSystem.hpp"
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace Fxt
+{
+namespace Hotspot
+{
+  // 呼び出しの種類 (ルーチンの識別子 = 種類 << 16 | 入口アドレス)
+  enum Kind : uint8_t { ROOT, JSR, IRQ, NMI, BRK };
+  static const char* const KIND_PREFIX[] = {"", "", "IRQ:", "NMI:", "BRK:"};
+
+  static constexpr int MAX_FRAMES = 256; // シャドウスタックの深さの上限 (超えた呼び出しは呼び出し元に数える)
+
+  // 呼び出し木のノード (根からの呼び出し経路ごとに1つ)
+  struct Node
+  {
+    uint32_t routine;
+    uint32_t parent;
+    uint64_t self  = 0; // この経路の先頭で実行したサイクル数
+    uint64_t calls = 0;
+  };
+
+  // シャドウスタックの1段
+  struct Frame
+  {
+    uint32_t node;
+    uint8_t  sp; // 戻りアドレスを積んだ直後の SP (これより上に SP が戻ったら抜けたとみなす)
+  };
+
+  struct State
+  {
+    uint64_t cycles[0x10000];         // PC ごとの消費サイクル数
+    uint64_t insns[0x10000];          // PC ごとの実行回数
+    uint64_t io_cycles[0x10000];      // I/O にアクセスした命令のサイクル数
+    uint64_t io_accesses[0x10000];    // I/O アクセス回数
+    uint32_t io = 0;                  // 実行中の命令の I/O アクセス回数
+    uint64_t start = 0;               // 計測開始時の sched.now
+    Io::Slot io_orig[Io::SLOT_COUNT]; // 差し替える前の I/O ハンドラ
+
+    // 呼び出しグラフ
+    std::vector<Node> nodes;                          // [0] = 根
+    std::unordered_map<uint64_t, uint32_t> children;  // (親 << 20 | ルーチン) → ノード
+    Frame frames[MAX_FRAMES];
+    int   depth = 0;
+  };
+
+  // アドレスの表示名 (シンボルがあれば "name+$off"、無ければ "$XXXX")
+  static std::string AddrName(const Symbols::Table& syms, uint16_t addr)
+  {
+    std::string name = Symbols::Format(syms, addr);
+    if (!name.empty()) return name;
+    char buf[8];
+    snprintf(buf, sizeof(buf), "$%04X", addr);
+    return buf;
+  }
+
+  // ルーチンの表示名
+  static std::string RoutineName(const Symbols::Table& syms, uint32_t routine)
+  {
+    if ((routine >> 16) == ROOT) return "(root)";
+    return KIND_PREFIX[routine >> 16] + AddrName(syms, routine & 0xFFFF);
+  }
+
+  // 子ノード (無ければ作る)
+  static uint32_t Child(State& h, uint32_t parent, uint32_t routine)
+  {
+    uint64_t key = (uint64_t)parent << 20 | routine;
+    auto it = h.children.find(key);
+    if (it != h.children.end()) return it->second;
+    Node n;
+    n.routine = routine;
+    n.parent  = parent;
+    h.nodes.push_back(n);
+    uint32_t idx = (uint32_t)h.nodes.size() - 1;
+    h.children[key] = idx;
+    return idx;
+  }
+
+  // 命令の先頭バイト (RAM・ROM 以外は分からないので 0xFF)
+  static uint8_t PeekOpcode(const System& sys, uint16_t pc)
+  {
+    if (pc < 0x8000)  return sys.ram[pc];
+    if (pc >= 0xF000) return sys.rom[pc & 0x0FFF];
+    return 0xFF;
+  }
+
+  // 1命令分の呼び出し・復帰をシャドウスタックに反映する
+  // 呼び出し: JSR (SP が2減る)、割り込み受付・BRK (SP が3減ってベクタへ飛ぶ)
+  // 復帰:     RTS / RTI に限らず、SP が戻りアドレスより上に戻った段をすべて降ろす
+  //           (戻りアドレスを PLA で捨てる、TXS でスタックを作り直すといった処理にも追従する)
+  static void TrackCall(System& sys, State& h, const Cpu::Regs& before, const Cpu::Regs& after, uint8_t opc)
+  {
+    while (h.depth && after.sp > h.frames[h.depth - 1].sp) h.depth--;
+
+    uint32_t kind = ROOT;
+    if (opc == 0x20 && after.sp == (uint8_t)(before.sp - 2))
+    {
+      kind = JSR;
+    }
+    else if (after.sp == (uint8_t)(before.sp - 3))
+    {
+      uint16_t nmi_vec = sys.rom[0xFFA] | sys.rom[0xFFB] << 8;
+      uint16_t irq_vec = sys.rom[0xFFE] | sys.rom[0xFFF] << 8;
+      uint8_t  pushed  = sys.ram[0x100 | (uint8_t)(after.sp + 1)]; // 積んだ P
+      if (after.pc == irq_vec)      kind = (pushed & 0x10) ? BRK : IRQ;
+      else if (after.pc == nmi_vec) kind = NMI;
+    }
+    if (kind == ROOT || h.depth == MAX_FRAMES) return;
+
+    uint32_t parent = h.depth ? h.frames[h.depth - 1].node : 0;
+    uint32_t node   = Child(h, parent, kind << 16 | after.pc);
+    h.nodes[node].calls++;
+    h.frames[h.depth].node = node;
+    h.frames[h.depth].sp   = after.sp;
+    h.depth++;
+  }
+
+  // 数えてから元のハンドラへ (ctx = State::io_orig の要素)
+  static uint8_t CountRead(System& sys, void* ctx, uint16_t addr)
+  {
+    const Io::Slot& slot = *static_cast<const Io::Slot*>(ctx);
+    sys.hotspot->io++;
+    return slot.read ? slot.read(sys, slot.ctx, addr) : 0;
+  }
+
+  static void CountWrite(System& sys, void* ctx, uint16_t addr, uint8_t val)
+  {
+    const Io::Slot& slot = *static_cast<const Io::Slot*>(ctx);
+    sys.hotspot->io++;
+    if (slot.write) slot.write(sys, slot.ctx, addr, val);
+  }
+
+  void HookIo(System& sys)
+  {
+    State& h = *sys.hotspot;
+    for (int i = 0; i < Io::SLOT_COUNT; i++)
+    {
+      Io::Slot& slot = sys.io[i];
+      if (slot.read == CountRead) continue; // 差し替え済み
+      h.io_orig[i] = slot;
+      slot.read  = CountRead;
+      slot.write = CountWrite;
+      slot.ctx   = &h.io_orig[i];
+    }
+  }
+
+  void Start(System& sys)
+  {
+    bool hooked = sys.hotspot != nullptr;
+    if (!sys.hotspot) sys.hotspot = new State();
+    State& h = *sys.hotspot;
+    std::fill(h.cycles,      h.cycles + 0x10000,      0);
+    std::fill(h.insns,       h.insns + 0x10000,       0);
+    std::fill(h.io_cycles,   h.io_cycles + 0x10000,   0);
+    std::fill(h.io_accesses, h.io_accesses + 0x10000, 0);
+    h.io    = 0;
+    h.start = sys.sched.now;
+    Node root;
+    root.routine = ROOT << 16;
+    root.parent  = 0;
+    h.nodes.assign(1, root);
+    h.children.clear();
+    h.depth = 0;
+    if (!hooked) HookIo(sys);
+  }
+
+  void Stop(System& sys)
+  {
+    if (!sys.hotspot) return;
+    // 差し替えていないスロット (計測中に登録し直されたもの) はそのまま
+    for (int i = 0; i < Io::SLOT_COUNT; i++)
+      if (sys.io[i].read == CountRead) sys.io[i] = sys.hotspot->io_orig[i];
+    delete sys.hotspot;
+    sys.hotspot = nullptr;
+  }
+
+  uint8_t Step(System& sys)
+  {
+    State&    h      = *sys.hotspot;
+    Cpu::Regs before = Cpu::GetRegs(sys);
+    uint16_t  pc     = before.pc;
+    uint8_t   opc    = PeekOpcode(sys, pc);
+    h.io = 0;
+    uint8_t cycles = Cpu::InstCycle(sys);
+    h.cycles[pc] += cycles;
+    h.insns[pc]++;
+    if (h.io)
+    {
+      h.io_cycles[pc]   += cycles;
+      h.io_accesses[pc] += h.io;
+    }
+
+    // 実行中のルーチンに数えてから、呼び出し・復帰を反映
+    h.nodes[h.depth ? h.frames[h.depth - 1].node : 0].self += cycles;
+    TrackCall(sys, h, before, Cpu::GetRegs(sys), opc);
+    return cycles;
+  }
+
+  // ルーチンごとの集計
+  struct RoutineStat
+  {
+    uint64_t calls = 0;
+    uint64_t incl  = 0; // 呼び出し先を含むサイクル数
+    uint64_t excl  = 0; // ルーチン自身のサイクル数
+  };
+
+  // 根からノードまでの経路 (folded stacks の1行)
+  static std::string FoldedPath(const System& sys, const State& h, uint32_t node)
+  {
+    std::vector<uint32_t> path;
+    for (uint32_t i = node;; i = h.nodes[i].parent)
+    {
+      path.push_back(h.nodes[i].routine);
+      if (i == 0) break;
+    }
+    std::string s;
+    for (size_t i = path.size(); i-- > 0;)
+    {
+      s += RoutineName(sys.symbols, path[i]);
+      if (i) s += ';';
+    }
+    return s;
+  }
+
+  static FILE* OpenOut(const std::string& path, FILE* log)
+  {
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp) fprintf(log, "[Hotspot] Error: %s を書き出せません\n", path.c_str());
+    return fp;
+  }
+
+  bool Dump(const System& sys, const std::string& base, FILE* log)
+  {
+    if (!sys.hotspot) return false;
+    const State& h = *sys.hotspot;
+
+    // 実行された PC をサイクル数の多い順に
+    std::vector<uint16_t> pcs;
+    uint64_t total = 0, total_insns = 0, total_io = 0;
+    for (int pc = 0; pc < 0x10000; pc++)
+    {
+      if (!h.insns[pc]) continue;
+      pcs.push_back((uint16_t)pc);
+      total       += h.cycles[pc];
+      total_insns += h.insns[pc];
+      total_io    += h.io_cycles[pc];
+    }
+    std::sort(pcs.begin(), pcs.end(), [&h](uint16_t a, uint16_t b)
+              { return h.cycles[a] != h.cycles[b] ? h.cycles[a] > h.cycles[b] : a < b; });
+
+    // ルーチンごとの自身・累積サイクル (再帰では経路上の同じルーチンを1回だけ数える)
+    std::map<uint32_t, RoutineStat> stats;
+    std::vector<uint32_t> seen;
+    for (uint32_t i = 0; i < h.nodes.size(); i++)
+    {
+      const Node&  n = h.nodes[i];
+      RoutineStat& r = stats[n.routine];
+      r.calls += n.calls;
+      r.excl  += n.self;
+      if (!n.self) continue;
+      seen.clear();
+      for (uint32_t j = i;; j = h.nodes[j].parent)
+      {
+        uint32_t rt = h.nodes[j].routine;
+        if (std::find(seen.begin(), seen.end(), rt) == seen.end())
+        {
+          seen.push_back(rt);
+          stats[rt].incl += n.self;
+        }
+        if (j == 0) break;
+      }
+    }
+    std::vector<std::pair<uint32_t, RoutineStat>> routines(stats.begin(), stats.end());
+    std::sort(routines.begin(), routines.end(),
+              [](const std::pair<uint32_t, RoutineStat>& a, const std::pair<uint32_t, RoutineStat>& b)
+              { return a.second.incl != b.second.incl ? a.second.incl > b.second.incl : a.first < b.first; });
+
+    std::string csv_path    = base + ".csv";
+    std::string json_path   = base + ".json";
+    std::string calls_path  = base + ".calls.csv";
+    std::string folded_path = base + ".folded";
+    FILE* csv    = OpenOut(csv_path, log);
+    FILE* json   = csv   ? OpenOut(json_path, log)   : nullptr;
+    FILE* calls  = json  ? OpenOut(calls_path, log)  : nullptr;
+    FILE* folded = calls ? OpenOut(folded_path, log) : nullptr;
+    if (!folded)
+    {
+      if (csv)   fclose(csv);
+      if (json)  fclose(json);
+      if (calls) fclose(calls);
+      return false;
+    }
+
+    // PC ごと
+    fprintf(csv, "pc,symbol,cycles,insns,io_cycles,io_accesses,cycles_pct\n");
+    fprintf(json, "{\n  \"start_cycle\": %" PRIu64 ",\n  \"end_cycle\": %" PRIu64 ",\n"
+                  "  \"cycles\": %" PRIu64 ",\n  \"insns\": %" PRIu64 ",\n  \"io_cycles\": %" PRIu64 ",\n"
+                  "  \"pcs\": [\n",
+            h.start, sys.sched.now, total, total_insns, total_io);
+    for (size_t i = 0; i < pcs.size(); i++)
+    {
+      uint16_t    pc  = pcs[i];
+      double      pct = total ? 100.0 * h.cycles[pc] / total : 0.0;
+      std::string sym = Symbols::Format(sys.symbols, pc);
+      fprintf(csv, "$%04X,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.4f\n",
+              pc, sym.c_str(), h.cycles[pc], h.insns[pc], h.io_cycles[pc], h.io_accesses[pc], pct);
+      fprintf(json, "    {\"pc\": \"$%04X\", \"symbol\": \"%s\", \"cycles\": %" PRIu64 ", \"insns\": %" PRIu64
+                    ", \"io_cycles\": %" PRIu64 ", \"io_accesses\": %" PRIu64 ", \"cycles_pct\": %.4f}%s\n",
+              pc, sym.c_str(), h.cycles[pc], h.insns[pc], h.io_cycles[pc], h.io_accesses[pc], pct,
+              i + 1 < pcs.size() ? "," : "");
+    }
+
+    // ルーチンごと
+    fprintf(calls, "routine,calls,inclusive,exclusive,inclusive_pct,exclusive_pct\n");
+    fprintf(json, "  ],\n  \"routines\": [\n");
+    for (size_t i = 0; i < routines.size(); i++)
+    {
+      const RoutineStat& r    = routines[i].second;
+      std::string        name = RoutineName(sys.symbols, routines[i].first);
+      double incl_pct = total ? 100.0 * r.incl / total : 0.0;
+      double excl_pct = total ? 100.0 * r.excl / total : 0.0;
+      fprintf(calls, "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.4f,%.4f\n",
+              name.c_str(), r.calls, r.incl, r.excl, incl_pct, excl_pct);
+      fprintf(json, "    {\"routine\": \"%s\", \"calls\": %" PRIu64 ", \"inclusive\": %" PRIu64
+                    ", \"exclusive\": %" PRIu64 ", \"inclusive_pct\": %.4f, \"exclusive_pct\": %.4f}%s\n",
+              name.c_str(), r.calls, r.incl, r.excl, incl_pct, excl_pct,
+              i + 1 < routines.size() ? "," : "");
+    }
+    fprintf(json, "  ]\n}\n");
+
+    // folded stacks (値はサイクル数)
+    for (uint32_t i = 0; i < h.nodes.size(); i++)
+      if (h.nodes[i].self)
+        fprintf(folded, "%s %" PRIu64 "\n", FoldedPath(sys, h, i).c_str(), h.nodes[i].self);
+
+    fclose(csv);
+    fclose(json);
+    fclose(calls);
+    fclose(folded);
+
+    fprintf(log, "[Hotspot] %" PRIu64 " cycles, %" PRIu64 " insns, %u PCs, %u routines -> %s.{csv,json,calls.csv,folded}\n",
+            total, total_insns, (unsigned)pcs.size(), (unsigned)routines.size(), base.c_str());
+    return true;
+  }
+
+} // namespace Hotspot
+} // namespace Fxt
@@ -0,0 +1,52 @@
+/* src/Hotspot.hpp - ゲストコードのホットスポット計測 (PC ごとのサイクル・命令数、呼び出しグラフ)
+ *
+ * 計測中は RunCycles が1命令ずつ実行し、命令の先頭 PC ごとに
+ *   - 消費サイクル数 (割り込み受付・WAI の待機はその時点の PC に数える)
+ *   - 実行回数
+ *   - I/O ($E000-$EFFF) にアクセスした命令のサイクル数とアクセス回数
+ * を 64K エントリのカウンタに積む。I/O にウェイトはないので、I/O 待ちは
+ * 「I/O を触った命令に費やしたサイクル」として数える。
+ * JIT・トレースキャッシュ・ROM 事前変換・待機ループの省略は使わず、インタプリタで実行する。
+ *
+ * あわせて JSR・割り込み受付 (IRQ / NMI / BRK) で積み、SP が戻りアドレスより上に戻ったら降ろす
+ * シャドウコールスタックを持ち、呼び出し経路ごとのサイクル数からルーチン (入口アドレス) ごとの
+ * 自身・累積サイクルを求める。RTS / RTI 以外でスタックを戻す処理 (PLA で戻りアドレスを捨てる、
+ * TXS でスタックを作り直す) にも SP で追従し、RTS による間接ジャンプは呼び出し元の中として数える。
+ *
+ * カウンタは Start で確保して System::hotspot に繋ぎ、Stop で解放する。
+ * I/O アクセスは計測中だけ I/O デコードテーブルのハンドラを数えるものに差し替えて数える。
+ * 計測していないときは RunCycles でポインタを1回見るだけ。
+ * Dump はサイクル数の多い順に PC ごとの CSV (base.csv)、ルーチンごとの CSV (base.calls.csv)、
+ * 両方を含む JSON (base.json) と、フレームグラフ用の folded stacks (base.folded) を書き出す。
+ * System::symbols にシンボルが読み込まれていれば、PC・ルーチンを "name+$off" でも示す。
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace Hotspot
+  {
+    // カウンタ本体 (Hotspot.cpp 内で定義)
+    struct State;
+
+    // 計測開始 (カウンタを確保してゼロにする)
+    void Start(System& sys);
+    // 計測終了 (カウンタを解放する)
+    void Stop(System& sys);
+
+    // I/O ハンドラを数えるものに差し替える (Init で登録し直した後にも呼ぶ)
+    void HookIo(System& sys);
+
+    // 1命令を実行してカウンタに積み、消費サイクル数を返す (RunCycles から呼ぶ)
+    uint8_t Step(System& sys);
+
+    // base.csv / base.calls.csv / base.json / base.folded を書き出す (計測中のみ)
+    bool Dump(const System& sys, const std::string& base, FILE* log = stderr);
+  }
+}
@@ -0,0 +1,1053 @@
+/* src/Jit.cpp - 65C02 基本ブロック JIT 実装 (x86-64 Linux) */
+#include "Jit.hpp"
+
+#if FXT_JIT
+
+#include "FxtSystem.hpp"
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+
+namespace Fxt
+{
+namespace Jit
+{
+  static constexpr size_t   CODE_SIZE   = 16 << 20; // 変換コード領域 [バイト]
+  static constexpr size_t   CODE_MARGIN = 64 << 10; // 1ブロックのコード長の上限見積もり
+  static constexpr size_t   MAX_BLOCKS  = 1 << 16;  // これを超えたらキャッシュを捨てる
+  static constexpr int      MAX_INSNS   = 64;       // 1ブロックの最大命令数
+  static constexpr int32_t  NO_BLOCK    = -1;       // 先頭が未対応命令で変換できない
+
+  // sys.jit_code のビット
+  static constexpr uint8_t CODE_BYTE  = 0x01; // 変換済みブロックの命令バイト
+  static constexpr uint8_t CODE_NOBLK = 0x02; // NO_BLOCK と判定した先頭アドレス
+
+  // 変換コードに渡すコンテキスト
+  struct Ctx
+  {
+    uint8_t*        ram;
+    const uint8_t*  rom;
+    const uint8_t*  nz;   // 値 → N/Z フラグ表
+    const uint8_t*  code; // sys.jit_code
+    W65c02::State*  cpu;
+    uint64_t        budget; // ブロック先頭へのループを続けてよい累計サイクル数の上限
+  };
+
+  // 変換コード: 実行したサイクル数を返す (0 = 1命令目の手前で抜けた)
+  typedef uint32_t (*BlockFn)(Ctx* ctx);
+
+  struct Block
+  {
+    BlockFn  fn;
+    uint32_t start, end; // 命令バイトの範囲 [start, end)
+    uint32_t max_start;  // 最後の命令の開始サイクルまでの最大値 (ブロック先頭基準)
+    bool     valid;
+  };
+
+  struct State
+  {
+    Ctx      ctx;
+    uint8_t  nz[256];
+    uint8_t* code      = nullptr;
+    size_t   code_used = 0;
+
+    std::vector<Block>    blocks;
+    std::vector<int32_t>  entry;      // 先頭アドレス → blocks 番号+1 (0 = 未変換)
+    std::vector<uint32_t> pages[256]; // ページ → そのページに掛かるブロック番号
+  };
+
+  // ---------------------------------------------------------------
+  //  x86-64 エンコーダ
+  // ---------------------------------------------------------------
+  enum Reg { EAX, ECX, EDX, EBX, ESP, EBP, ESI, EDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+  static constexpr int NOREG = -1;
+
+  // ゲストレジスタ・固定ポインタの割り当て
+  static constexpr int RA    = R8;  // A
+  static constexpr int RX    = R9;  // X
+  static constexpr int RY    = R10; // Y
+  static constexpr int RS    = R11; // SP
+  static constexpr int RP    = EBP; // P
+  static constexpr int RCYC  = EDI; // ページ跨ぎの追加サイクル
+  static constexpr int RCPU  = EBX; // &cpu
+  static constexpr int RRAM  = R12;
+  static constexpr int RROM  = R13;
+  static constexpr int RNZ   = R14;
+  static constexpr int RCODE = R15;
+
+  // 2オペランド命令 (op r/m32, r32)
+  enum : uint8_t { OP_ADD = 0x01, OP_OR = 0x09, OP_AND = 0x21, OP_SUB = 0x29,
+                   OP_XOR = 0x31, OP_CMP = 0x39, OP_TEST = 0x85, OP_MOV = 0x89 };
+  // 即値命令 (0x81 /ext)
+  enum : int { EXT_ADD = 0, EXT_OR = 1, EXT_SBB = 3, EXT_AND = 4, EXT_SUB = 5, EXT_XOR = 6, EXT_CMP = 7 };
+  // 条件コード
+  enum : int { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7 };
+
+  struct Emitter
+  {
+    uint8_t* buf;
+    size_t   pos;
+    size_t   cap;
+    bool     overflow = false;
+
+    void B(uint32_t v) { if (pos < cap) buf[pos++] = (uint8_t)v; else overflow = true; }
+    void W(uint32_t v) { B(v); B(v >> 8); }
+    void D(uint32_t v) { W(v); W(v >> 16); }
+
+    // REX は常に付ける (spl/bpl/sil/dil のバイトアクセスもこれで揃う)
+    void Rex(bool w, int reg, int index, int base)
+    {
+      B(0x40 | (w ? 0x08 : 0) | ((reg >> 3) & 1) << 2 |
+        (index >= 0 ? ((index >> 3) & 1) << 1 : 0) | ((base >> 3) & 1));
+    }
+    // [base + index + disp32]
+    void Mem(int reg, int base, int index, int32_t disp)
+    {
+      if (index < 0 && (base & 7) != ESP)
+        B(0x80 | (reg & 7) << 3 | (base & 7));
+      else
+      {
+        B(0x84 | (reg & 7) << 3);
+        B((index < 0 ? 4 : (index & 7)) << 3 | (base & 7));
+      }
+      D((uint32_t)disp);
+    }
+    void ModReg(int reg, int rm) { B(0xC0 | (reg & 7) << 3 | (rm & 7)); }
+
+    void AluRR(uint8_t op, int dst, int src) { Rex(false, src, NOREG, dst); B(op); ModReg(src, dst); }
+    void AluRI(int ext, int dst, uint32_t imm) { Rex(false, ext, NOREG, dst); B(0x81); ModReg(ext, dst); D(imm); }
+    void MovRI(int dst, uint32_t imm) { Rex(false, 0, NOREG, dst); B(0xB8 | (dst & 7)); D(imm); }
+    void Load8(int dst, int base, int index, int32_t disp)
+    {
+      Rex(false, dst, index, base); B(0x0F); B(0xB6); Mem(dst, base, index, disp);
+    }
+    void Load64(int dst, int base, int32_t disp) { Rex(true, dst, NOREG, base); B(0x8B); Mem(dst, base, NOREG, disp); }
+    void Store8(int base, int index, int32_t disp, int src)
+    {
+      Rex(false, src, index, base); B(0x88); Mem(src, base, index, disp);
+    }
+    void Store8I(int base, int index, int32_t disp, uint8_t imm)
+    {
+      Rex(false, 0, index, base); B(0xC6); Mem(0, base, index, disp); B(imm);
+    }
+    void Store16(int base, int32_t disp, int src)
+    {
+      B(0x66); Rex(false, src, NOREG, base); B(0x89); Mem(src, base, NOREG, disp);
+    }
+    void Store16I(int base, int32_t disp, uint16_t imm)
+    {
+      B(0x66); Rex(false, 0, NOREG, base); B(0xC7); Mem(0, base, NOREG, disp); W(imm);
+    }
+    void Cmp8I(int base, int index, int32_t disp, uint8_t imm)
+    {
+      Rex(false, 7, index, base); B(0x80); Mem(7, base, index, disp); B(imm);
+    }
+    void Lea(int dst, int base, int32_t disp) { Rex(false, dst, NOREG, base); B(0x8D); Mem(dst, base, NOREG, disp); }
+    void Movzx8(int dst, int src)  { Rex(false, dst, NOREG, src); B(0x0F); B(0xB6); ModReg(dst, src); }
+    void Movzx16(int dst, int src) { Rex(false, dst, NOREG, src); B(0x0F); B(0xB7); ModReg(dst, src); }
+    void Shl(int dst, uint8_t n) { Rex(false, 4, NOREG, dst); B(0xC1); ModReg(4, dst); B(n); }
+    void Shr(int dst, uint8_t n) { Rex(false, 5, NOREG, dst); B(0xC1); ModReg(5, dst); B(n); }
+    void Setcc(int cc, int dst) { Rex(false, 0, NOREG, dst); B(0x0F); B(0x90 | cc); ModReg(0, dst); }
+    void TestRI(int dst, uint32_t imm) { Rex(false, 0, NOREG, dst); B(0xF7); ModReg(0, dst); D(imm); }
+    void CmpRM(int reg, int base, int32_t disp) { Rex(false, reg, NOREG, base); B(0x3B); Mem(reg, base, NOREG, disp); }
+    void Push(int r) { Rex(false, 0, NOREG, r); B(0x50 | (r & 7)); }
+    void PushMem(int base, int32_t disp) { Rex(false, 6, NOREG, base); B(0xFF); Mem(6, base, NOREG, disp); }
+    void Pop(int r)  { Rex(false, 0, NOREG, r); B(0x58 | (r & 7)); }
+    void Ret() { B(0xC3); }
+
+    // 分岐 (rel32 の位置を返し、後で Patch する)
+    size_t Jcc(int cc) { B(0x0F); B(0x80 | cc); size_t at = pos; D(0); return at; }
+    size_t Jmp() { B(0xE9); size_t at = pos; D(0); return at; }
+    void Patch(size_t at, size_t target)
+    {
+      if (at + 4 > cap) return;
+      int32_t rel = (int32_t)(target - (at + 4));
+      memcpy(buf + at, &rel, 4);
+    }
+  };
+
+  // ---------------------------------------------------------------
+  //  変換
+  // ---------------------------------------------------------------
+
+  // ブロックの出口
+  struct Exit
+  {
+    size_t   at;       // Jcc の rel32 位置
+    uint16_t pc;       // 次に実行するアドレス
+    uint32_t cycles;   // ブロック先頭からの静的サイクル数
+    bool     has_last; // 1命令以上実行済みか
+    uint8_t  opc;      // 最後に実行した命令
+    uint16_t opc_addr;
+    bool     loop;     // 行き先がブロック先頭 (予算内なら抜けずにループ)
+  };
+
+  struct Translator
+  {
+    System&  sys;
+    Emitter  e;
+    std::vector<size_t> to_epilogue; // エピローグへの jmp
+    std::vector<Exit>   exits;       // 条件付きの出口 (本体の後ろにまとめて置く)
+
+    // 変換中の命令
+    uint16_t pc;
+    uint8_t  opc;
+    uint8_t  op8;
+    uint16_t op16;
+    uint32_t cycles = 0;     // この命令の手前までの静的サイクル数
+    bool     has_last = false;
+    uint8_t  last_opc = 0;
+    uint16_t last_addr = 0;
+
+    uint16_t start;          // ブロック先頭
+    size_t   loop_start = 0; // ループで戻る位置 (プロローグの後)
+
+    Translator(System& s, Emitter em) : sys(s), e(em) {}
+
+    uint8_t Peek(uint32_t addr) const
+    {
+      return addr < 0x8000 ? sys.ram[addr] : sys.rom[addr & 0x0FFF];
+    }
+
+    // --- 出口 ---
+
+    void ExitBody(uint16_t to, uint32_t cyc, bool has, uint8_t o, uint16_t oa, bool dyn_pc)
+    {
+      if (has)
+      {
+        e.Store8I(RCPU, NOREG, offsetof(W65c02::State, opcode), o);
+        e.Store16I(RCPU, offsetof(W65c02::State, opcode_addr), oa);
+      }
+      if (!dyn_pc) e.Store16I(RCPU, offsetof(W65c02::State, pc), to);
+      e.Lea(EAX, RCYC, (int32_t)cyc);
+      to_epilogue.push_back(e.Jmp());
+    }
+
+    // この命令を実行せずに抜ける (条件成立時)
+    void SideExit(int cc)
+    {
+      Exit x = { e.Jcc(cc), pc, cycles, has_last, last_opc, last_addr, false };
+      exits.push_back(x);
+    }
+
+    // この命令の後で抜ける (条件成立時)
+    void ExitAfterIf(int cc, uint16_t to, uint32_t cyc)
+    {
+      Exit x = { e.Jcc(cc), to, cycles + cyc, true, opc, pc, to == start };
+      exits.push_back(x);
+    }
+
+    // この命令の後で抜ける
+    void ExitAfter(uint16_t to, uint32_t cyc)
+    {
+      if (to == start) LoopBack(cycles + cyc, opc, pc);
+      else             ExitBody(to, cycles + cyc, true, opc, pc, false);
+    }
+
+    // ブロック先頭へ戻る: 累計サイクル数が予算 ([rsp]) 以内なら抜けずに続ける
+    void LoopBack(uint32_t cyc, uint8_t o, uint16_t oa)
+    {
+      e.Lea(EAX, RCYC, (int32_t)cyc);
+      e.CmpRM(EAX, ESP, 0);
+      Exit x = { e.Jcc(CC_A), start, cyc, true, o, oa, false };
+      exits.push_back(x);
+      // 次の周回の1命令目で抜けたときのために直前の命令を残す
+      e.Store8I(RCPU, NOREG, offsetof(W65c02::State, opcode), o);
+      e.Store16I(RCPU, offsetof(W65c02::State, opcode_addr), oa);
+      e.AluRR(OP_MOV, RCYC, EAX);
+      e.Patch(e.Jmp(), loop_start);
+    }
+
+    // --- フラグ ---
+
+    // N/Z を reg (0-255) から設定 (clear=false なら呼び出し側でクリア済み)
+    void SetNZ(int reg, bool clear = true)
+    {
+      if (clear) e.AluRI(EXT_AND, RP, ~(uint32_t)(W65c02::FLAG_N | W65c02::FLAG_Z));
+      e.Load8(ECX, RNZ, reg, 0);
+      e.AluRR(OP_OR, RP, ECX);
+    }
+
+    // Z = !(edx & A)
+    void SetZTest(int reg)
+    {
+      e.AluRI(EXT_AND, RP, ~(uint32_t)W65c02::FLAG_Z);
+      e.AluRR(OP_TEST, reg, RA);
+      e.Setcc(CC_E, ECX);
+      e.Movzx8(ECX, ECX);
+      e.AluRR(OP_ADD, ECX, ECX);
+      e.AluRR(OP_OR, RP, ECX);
+    }
+
+    // --- アドレッシング ---
+
+    // konst: 定数アドレス / ram・rom: 動的だが必ず RAM・ROM に収まる
+    struct Ea { bool konst; uint16_t addr; bool ram; bool rom; };
+
+    // 実効アドレス: ZP / AB は定数、それ以外は eax に求める (YIN/YIP の基底は edx)
+    Ea Address(W65c02::Mode mode)
+    {
+      using namespace W65c02;
+      switch (mode)
+      {
+        case ZP: { Ea ea = { true, op8,  true, false };        return ea; }
+        case AB: { Ea ea = { true, op16, op16 < 0x8000, op16 >= 0xF000 }; return ea; }
+        case ZPX: e.Lea(EAX, RX, op8); e.Movzx8(EAX, EAX); break;
+        case ZPY: e.Lea(EAX, RY, op8); e.Movzx8(EAX, EAX); break;
+        case ZPI:
+        case YIN:
+        case YIP:
+          e.Load8(EAX, RRAM, NOREG, op8);
+          e.Load8(ECX, RRAM, NOREG, (uint8_t)(op8 + 1));
+          e.Shl(ECX, 8);
+          e.AluRR(OP_OR, EAX, ECX);
+          if (mode != ZPI)
+          {
+            e.AluRR(OP_MOV, EDX, EAX);
+            e.AluRR(OP_ADD, EAX, RY);
+            e.Movzx16(EAX, EAX);
+          }
+          break;
+        case XIN:
+          e.Lea(EDX, RX, op8);
+          e.Movzx8(EDX, EDX);
+          e.Load8(EAX, RRAM, EDX, 0);
+          e.Lea(EDX, EDX, 1);
+          e.Movzx8(EDX, EDX);
+          e.Load8(ECX, RRAM, EDX, 0);
+          e.Shl(ECX, 8);
+          e.AluRR(OP_OR, EAX, ECX);
+          break;
+        case ABX: case AXP: e.Lea(EAX, RX, op16); e.Movzx16(EAX, EAX); break;
+        case ABY: case AYP: e.Lea(EAX, RY, op16); e.Movzx16(EAX, EAX); break;
+        default: break;
+      }
+      // インデックス付きの範囲が RAM・ROM に収まるか
+      Ea ea = { false, 0, false, false };
+      if (mode == ZPX || mode == ZPY) ea.ram = true;
+      if (mode == ABX || mode == AXP || mode == ABY || mode == AYP)
+      {
+        ea.ram = op16 + 0xFF < 0x8000;
+        ea.rom = op16 >= 0xF000 && op16 + 0xFF <= 0xFFFF;
+      }
+      return ea;
+    }
+
+    // ページ跨ぎの追加サイクル (アクセス可否の判定より後に加算する)
+    void Penalty(W65c02::Mode mode)
+    {
+      using namespace W65c02;
+      if (mode == AXP || mode == AYP)
+      {
+        // index >= 0x100 - 下位バイト なら跨ぐ: cmp で CF = 跨がない
+        e.AluRI(EXT_CMP, mode == AXP ? RX : RY, 0x100 - (op16 & 0xFF));
+        e.AluRI(EXT_SBB, RCYC, 0xFFFFFFFF);
+      }
+      else if (mode == YIP)
+      {
+        e.AluRR(OP_XOR, EDX, EAX);
+        e.TestRI(EDX, 0xFF00);
+        e.Setcc(CC_NE, ECX);
+        e.Movzx8(ECX, ECX);
+        e.AluRR(OP_ADD, RCYC, ECX);
+      }
+    }
+
+    // オペランドを esi に読む (RAM / ROM 以外なら抜ける)
+    void Read(W65c02::Mode mode)
+    {
+      if (mode == W65c02::IMM) { e.MovRI(ESI, op8); return; }
+
+      Ea ea = Address(mode);
+      if (ea.konst)
+      {
+        if (ea.addr < 0x8000) e.Load8(ESI, RRAM, NOREG, ea.addr);
+        else                  e.Load8(ESI, RROM, NOREG, ea.addr - 0xF000);
+      }
+      else if (ea.ram) e.Load8(ESI, RRAM, EAX, 0);
+      else if (ea.rom) e.Load8(ESI, RROM, EAX, -0xF000);
+      else
+      {
+        e.AluRI(EXT_CMP, EAX, 0x8000);
+        size_t to_rom = e.Jcc(CC_AE);
+        e.Load8(ESI, RRAM, EAX, 0);
+        size_t done = e.Jmp();
+        e.Patch(to_rom, e.pos);
+        e.AluRI(EXT_CMP, EAX, 0xF000);
+        SideExit(CC_B);
+        e.Load8(ESI, RROM, EAX, -0xF000);
+        e.Patch(done, e.pos);
+      }
+      Penalty(mode);
+    }
+
+    // 書き込み先を求める (RAM 以外、または変換済み命令バイトなら抜ける)
+    Ea WriteTarget(W65c02::Mode mode)
+    {
+      Ea ea = Address(mode);
+      if (ea.konst)
+      {
+        e.Cmp8I(RCODE, NOREG, ea.addr, 0);
+        SideExit(CC_NE);
+      }
+      else
+      {
+        if (!ea.ram)
+        {
+          e.AluRI(EXT_CMP, EAX, 0x8000);
+          SideExit(CC_AE);
+        }
+        e.Cmp8I(RCODE, EAX, 0, 0);
+        SideExit(CC_NE);
+      }
+      Penalty(mode);
+      return ea;
+    }
+
+    void LoadRam(const Ea& ea, int dst)
+    {
+      if (ea.konst) e.Load8(dst, RRAM, NOREG, ea.addr);
+      else          e.Load8(dst, RRAM, EAX, 0);
+    }
+
+    void StoreRam(const Ea& ea, int src)
+    {
+      if (ea.konst) e.Store8(RRAM, NOREG, ea.addr, src);
+      else          e.Store8(RRAM, EAX, 0, src);
+    }
+
+    // --- スタック ---
+
+    // push できなければ抜ける
+    void CheckPush(int slot_reg) { e.Cmp8I(RCODE, slot_reg, 0x100, 0); SideExit(CC_NE); }
+
+    void Pop(int dst)
+    {
+      e.AluRI(EXT_ADD, RS, 1);
+      e.AluRI(EXT_AND, RS, 0xFF);
+      e.Load8(dst, RRAM, RS, 0x100);
+    }
+
+    // --- 演算 (値は edx) ---
+
+    void Modify(W65c02::Op op)
+    {
+      using namespace W65c02;
+      const uint32_t CLEAR_CNZ = ~(uint32_t)(FLAG_C | FLAG_N | FLAG_Z);
+      switch (op)
+      {
+        case ASL:
+          e.AluRR(OP_MOV, ECX, EDX); e.Shr(ECX, 7);
+          e.AluRI(EXT_AND, RP, CLEAR_CNZ); e.AluRR(OP_OR, RP, ECX);
+          e.AluRR(OP_ADD, EDX, EDX); e.Movzx8(EDX, EDX);
+          SetNZ(EDX, false);
+          break;
+        case LSR:
+          e.AluRR(OP_MOV, ECX, EDX); e.AluRI(EXT_AND, ECX, 1);
+          e.AluRI(EXT_AND, RP, CLEAR_CNZ); e.AluRR(OP_OR, RP, ECX);
+          e.Shr(EDX, 1);
+          SetNZ(EDX, false);
+          break;
+        case ROL:
+          e.AluRR(OP_MOV, ECX, RP); e.AluRI(EXT_AND, ECX, 1);
+          e.AluRR(OP_ADD, EDX, EDX); e.AluRR(OP_OR, EDX, ECX);
+          e.AluRR(OP_MOV, ECX, EDX); e.Shr(ECX, 8);
+          e.AluRI(EXT_AND, RP, CLEAR_CNZ); e.AluRR(OP_OR, RP, ECX);
+          e.Movzx8(EDX, EDX);
+          SetNZ(EDX, false);
+          break;
+        case ROR:
+          e.AluRR(OP_MOV, ECX, RP); e.AluRI(EXT_AND, ECX, 1); e.Shl(ECX, 8);
+          e.AluRR(OP_OR, EDX, ECX);
+          e.AluRR(OP_MOV, ECX, EDX); e.AluRI(EXT_AND, ECX, 1);
+          e.AluRI(EXT_AND, RP, CLEAR_CNZ); e.AluRR(OP_OR, RP, ECX);
+          e.Shr(EDX, 1);
+          SetNZ(EDX, false);
+          break;
+        case INC:
+        case DEC:
+          e.AluRI(op == INC ? EXT_ADD : EXT_SUB, EDX, 1);
+          e.Movzx8(EDX, EDX);
+          SetNZ(EDX);
+          break;
+        default:
+          break;
+      }
+    }
+
+    // A + esi + C (SBC は esi を反転済み)
+    void AddWithCarry()
+    {
+      using namespace W65c02;
+      e.AluRR(OP_MOV, EDX, RA);
+      e.AluRR(OP_ADD, EDX, ESI);
+      e.AluRR(OP_MOV, ECX, RP);
+      e.AluRI(EXT_AND, ECX, FLAG_C);
+      e.AluRR(OP_ADD, EDX, ECX);
+      // V = (A ^ r) & (m ^ r) & 0x80
+      e.AluRR(OP_MOV, ECX, RA);
+      e.AluRR(OP_XOR, ECX, EDX);
+      e.AluRR(OP_MOV, EAX, ESI);
+      e.AluRR(OP_XOR, EAX, EDX);
+      e.AluRR(OP_AND, ECX, EAX);
+      e.AluRI(EXT_AND, ECX, 0x80);
+      e.Shr(ECX, 1);
+      e.AluRI(EXT_AND, RP, ~(uint32_t)(FLAG_C | FLAG_V | FLAG_N | FLAG_Z));
+      e.AluRR(OP_OR, RP, ECX);
+      // C = r > 0xFF
+      e.AluRR(OP_MOV, ECX, EDX);
+      e.Shr(ECX, 8);
+      e.AluRR(OP_OR, RP, ECX);
+      e.Movzx8(RA, EDX);
+      SetNZ(RA, false);
+    }
+
+    void Compare(int reg)
+    {
+      using namespace W65c02;
+      e.AluRR(OP_MOV, EDX, reg);
+      e.AluRR(OP_SUB, EDX, ESI);
+      e.Setcc(CC_AE, ECX);
+      e.Movzx8(ECX, ECX);
+      e.AluRI(EXT_AND, RP, ~(uint32_t)(FLAG_C | FLAG_N | FLAG_Z));
+      e.AluRR(OP_OR, RP, ECX);
+      e.Movzx8(EDX, EDX);
+      SetNZ(EDX, false);
+    }
+
+    // 条件分岐 (REL): flag の状態が set と一致すれば分岐
+    void Branch(uint8_t flag, bool set, uint32_t base)
+    {
+      uint16_t next   = pc + 2;
+      uint16_t target = next + (int8_t)op8;
+      uint32_t taken  = base + 1 + (((next ^ target) & 0xFF00) != 0);
+      e.TestRI(RP, flag);
+      ExitAfterIf(set ? CC_NE : CC_E, target, taken);
+      ExitAfter(next, base);
+    }
+
+    // --- 命令 ---
+
+    // 命令長
+    static int Length(W65c02::Op op, W65c02::Mode mode)
+    {
+      using namespace W65c02;
+      if (op == BBR || op == BBS) return 3;
+      switch (mode)
+      {
+        case IMP: case ACC: return 1;
+        case AB: case ABX: case ABY: case AXP: case AYP: case IND: case INDX: return 3;
+        default: return 2;
+      }
+    }
+
+    // 変換できる命令か (定数アドレスが I/O なら不可)
+    bool Supported(W65c02::Op op, W65c02::Mode mode) const
+    {
+      using namespace W65c02;
+      uint16_t addr = (mode == AB) ? op16 : op8;
+      bool konst    = (mode == AB || mode == ZP);
+      bool readable = !konst || addr < 0x8000 || addr >= 0xF000;
+      bool writable = !konst || addr < 0x8000;
+
+      switch (op)
+      {
+        case LDA: case LDX: case LDY: case AND: case ORA: case EOR:
+        case ADC: case SBC: case CMP: case CPX: case CPY: case BIT:
+          return readable;
+        case LDD:
+          return mode == IMM || mode == ZP || mode == ZPX || (mode == AB && readable);
+        case STA: case STX: case STY: case STZ:
+        case TRB: case TSB: case RMB: case SMB:
+          return writable;
+        case ASL: case LSR: case ROL: case ROR: case INC: case DEC:
+          return mode == ACC || writable;
+        case NOP:
+          return OPCODES[opc].cycles != 1; // 1サイクルNOPは割り込み判定が特殊なので対象外
+        case JMP: case JSR:
+          return mode == AB;
+        case BRK: case RTI: case WAI: case STP:
+          return false;
+        default:
+          return true;
+      }
+    }
+
+    // 命令を1つ変換。ブロックが終わる命令なら true
+    bool Emit(W65c02::Op op, W65c02::Mode mode, uint32_t base)
+    {
+      using namespace W65c02;
+      switch (op)
+      {
+        // --- ロード・演算 ---
+        case LDA: Read(mode); e.AluRR(OP_MOV, RA, ESI); SetNZ(RA); break;
+        case LDX: Read(mode); e.AluRR(OP_MOV, RX, ESI); SetNZ(RX); break;
+        case LDY: Read(mode); e.AluRR(OP_MOV, RY, ESI); SetNZ(RY); break;
+        case AND: Read(mode); e.AluRR(OP_AND, RA, ESI); SetNZ(RA); break;
+        case ORA: Read(mode); e.AluRR(OP_OR,  RA, ESI); SetNZ(RA); break;
+        case EOR: Read(mode); e.AluRR(OP_XOR, RA, ESI); SetNZ(RA); break;
+        case CMP: Read(mode); Compare(RA); break;
+        case CPX: Read(mode); Compare(RX); break;
+        case CPY: Read(mode); Compare(RY); break;
+        case ADC:
+        case SBC:
+          // 10進モードはインタプリタへ
+          e.TestRI(RP, FLAG_D);
+          SideExit(CC_NE);
+          Read(mode);
+          if (op == SBC) e.AluRI(EXT_XOR, ESI, 0xFF);
+          AddWithCarry();
+          break;
+        case BIT:
+          Read(mode);
+          if (mode != IMM)
+          {
+            e.AluRI(EXT_AND, RP, ~(uint32_t)(FLAG_N | FLAG_V));
+            e.AluRR(OP_MOV, ECX, ESI);
+            e.AluRI(EXT_AND, ECX, FLAG_N | FLAG_V);
+            e.AluRR(OP_OR, RP, ECX);
+          }
+          SetZTest(ESI);
+          break;
+        case LDD:
+          break; // 読み捨て (RAM / ROM なので副作用なし)
+
+        // --- ストア ---
+        case STA: case STX: case STY: case STZ:
+          {
+            Ea ea = WriteTarget(mode);
+            if (op == STZ)
+            {
+              if (ea.konst) e.Store8I(RRAM, NOREG, ea.addr, 0);
+              else          e.Store8I(RRAM, EAX, 0, 0);
+            }
+            else StoreRam(ea, op == STA ? RA : op == STX ? RX : RY);
+          }
+          break;
+
+        // --- シフト・インクリメント ---
+        case ASL: case LSR: case ROL: case ROR: case INC: case DEC:
+          if (mode == ACC)
+          {
+            e.AluRR(OP_MOV, EDX, RA);
+            Modify(op);
+            e.AluRR(OP_MOV, RA, EDX);
+          }
+          else
+          {
+            Ea ea = WriteTarget(mode);
+            LoadRam(ea, EDX);
+            Modify(op);
+            StoreRam(ea, EDX);
+          }
+          break;
+
+        case TRB:
+        case TSB:
+          {
+            Ea ea = WriteTarget(mode);
+            LoadRam(ea, EDX);
+            SetZTest(EDX);
+            if (op == TSB) e.AluRR(OP_OR, EDX, RA);
+            else
+            {
+              e.AluRR(OP_MOV, ECX, RA);
+              e.AluRI(EXT_XOR, ECX, 0xFF);
+              e.AluRR(OP_AND, EDX, ECX);
+            }
+            StoreRam(ea, EDX);
+          }
+          break;
+
+        case RMB:
+        case SMB:
+          {
+            uint8_t bit = 1 << ((opc >> 4) & 7);
+            Ea ea = WriteTarget(mode);
+            LoadRam(ea, EDX);
+            if (op == RMB) e.AluRI(EXT_AND, EDX, (uint8_t)~bit);
+            else           e.AluRI(EXT_OR,  EDX, bit);
+            StoreRam(ea, EDX);
+          }
+          break;
+
+        case INX: e.AluRI(EXT_ADD, RX, 1); e.AluRI(EXT_AND, RX, 0xFF); SetNZ(RX); break;
+        case INY: e.AluRI(EXT_ADD, RY, 1); e.AluRI(EXT_AND, RY, 0xFF); SetNZ(RY); break;
+        case DEX: e.AluRI(EXT_SUB, RX, 1); e.AluRI(EXT_AND, RX, 0xFF); SetNZ(RX); break;
+        case DEY: e.AluRI(EXT_SUB, RY, 1); e.AluRI(EXT_AND, RY, 0xFF); SetNZ(RY); break;
+
+        // --- 転送 ---
+        case TAX: e.AluRR(OP_MOV, RX, RA); SetNZ(RX); break;
+        case TAY: e.AluRR(OP_MOV, RY, RA); SetNZ(RY); break;
+        case TXA: e.AluRR(OP_MOV, RA, RX); SetNZ(RA); break;
+        case TYA: e.AluRR(OP_MOV, RA, RY); SetNZ(RA); break;
+        case TSX: e.AluRR(OP_MOV, RX, RS); SetNZ(RX); break;
+        case TXS: e.AluRR(OP_MOV, RS, RX); break;
+
+        // --- スタック ---
+        case PHA: case PHX: case PHY: case PHP:
+          CheckPush(RS);
+          if (op == PHP)
+          {
+            e.AluRR(OP_MOV, ECX, RP);
+            e.AluRI(EXT_OR, ECX, FLAG_B | FLAG_U);
+            e.Store8(RRAM, RS, 0x100, ECX);
+          }
+          else e.Store8(RRAM, RS, 0x100, op == PHA ? RA : op == PHX ? RX : RY);
+          e.AluRI(EXT_SUB, RS, 1);
+          e.AluRI(EXT_AND, RS, 0xFF);
+          break;
+        case PLA: Pop(RA); SetNZ(RA); break;
+        case PLX: Pop(RX); SetNZ(RX); break;
+        case PLY: Pop(RY); SetNZ(RY); break;
+        case PLP:
+          // I が変わり得るので CLI と同様にここで抜ける
+          Pop(RP);
+          e.AluRI(EXT_OR, RP, FLAG_B | FLAG_U);
+          ExitAfter(pc + 1, base);
+          return true;
+
+        // --- フラグ ---
+        case CLC: e.AluRI(EXT_AND, RP, ~(uint32_t)FLAG_C); break;
+        case CLD: e.AluRI(EXT_AND, RP, ~(uint32_t)FLAG_D); break;
+        case CLI:
+          // マスク中の IRQ を次の命令境界で受け付けられるよう、ここで抜ける
+          e.AluRI(EXT_AND, RP, ~(uint32_t)FLAG_I);
+          ExitAfter(pc + 1, base);
+          return true;
+        case CLV: e.AluRI(EXT_AND, RP, ~(uint32_t)FLAG_V); break;
+        case SEC: e.AluRI(EXT_OR,  RP, FLAG_C); break;
+        case SED: e.AluRI(EXT_OR,  RP, FLAG_D); break;
+        case SEI: e.AluRI(EXT_OR,  RP, FLAG_I); break;
+
+        case NOP: break;
+
+        // --- 分岐 (ブロック終端) ---
+        case BCC: Branch(FLAG_C, false, base); return true;
+        case BCS: Branch(FLAG_C, true,  base); return true;
+        case BNE: Branch(FLAG_Z, false, base); return true;
+        case BEQ: Branch(FLAG_Z, true,  base); return true;
+        case BPL: Branch(FLAG_N, false, base); return true;
+        case BMI: Branch(FLAG_N, true,  base); return true;
+        case BVC: Branch(FLAG_V, false, base); return true;
+        case BVS: Branch(FLAG_V, true,  base); return true;
+        case BRA:
+          {
+            uint16_t next   = pc + 2;
+            uint16_t target = next + (int8_t)op8;
+            ExitAfter(target, base + 1 + (((next ^ target) & 0xFF00) != 0));
+          }
+          return true;
+
+        case BBR:
+        case BBS:
+          {
+            uint8_t  bit    = 1 << ((opc >> 4) & 7);
+            uint8_t  offset = Peek((uint16_t)(pc + 2));
+            uint16_t target = pc + 3 + (int8_t)offset;
+            e.Load8(EDX, RRAM, NOREG, op8);
+            e.TestRI(EDX, bit);
+            ExitAfterIf(op == BBR ? CC_E : CC_NE, target, base);
+            ExitAfter(pc + 3, base);
+          }
+          return true;
+
+        // --- ジャンプ・サブルーチン (ブロック終端) ---
+        case JMP:
+          ExitAfter(op16, base);
+          return true;
+
+        case JSR:
+          {
+            uint16_t ret = pc + 2;
+            // 2バイト分の書き込み先を先に確認する
+            CheckPush(RS);
+            e.Lea(ECX, RS, -1);
+            e.Movzx8(ECX, ECX);
+            CheckPush(ECX);
+            e.Store8I(RRAM, RS, 0x100, ret >> 8);
+            e.Store8I(RRAM, ECX, 0x100, ret & 0xFF);
+            e.Lea(RS, RS, -2);
+            e.Movzx8(RS, RS);
+            ExitAfter(op16, base);
+          }
+          return true;
+
+        case RTS:
+          Pop(EAX);
+          Pop(EDX);
+          e.Shl(EDX, 8);
+          e.AluRR(OP_OR, EAX, EDX);
+          e.AluRI(EXT_ADD, EAX, 1);
+          e.Store16(RCPU, offsetof(W65c02::State, pc), EAX);
+          ExitBody(0, cycles + base, true, opc, pc, true);
+          return true;
+
+        default:
+          break;
+      }
+      return false;
+    }
+
+    // ブロック全体を変換。命令を1つも変換できなければ false
+    bool Run(uint16_t from, uint32_t& end, uint32_t& max_start)
+    {
+      using namespace W65c02;
+
+      // プロローグ: 呼び出し先保存レジスタを退避し、ゲスト状態をロード
+      e.Push(EBX); e.Push(EBP); e.Push(R12); e.Push(R13); e.Push(R14); e.Push(R15);
+      e.Load64(RRAM,  EDI, offsetof(Ctx, ram));
+      e.Load64(RROM,  EDI, offsetof(Ctx, rom));
+      e.Load64(RNZ,   EDI, offsetof(Ctx, nz));
+      e.Load64(RCODE, EDI, offsetof(Ctx, code));
+      e.Load64(RCPU,  EDI, offsetof(Ctx, cpu));
+      e.Load8(RA, RCPU, NOREG, offsetof(W65c02::State, a));
+      e.Load8(RX, RCPU, NOREG, offsetof(W65c02::State, x));
+      e.Load8(RY, RCPU, NOREG, offsetof(W65c02::State, y));
+      e.Load8(RS, RCPU, NOREG, offsetof(W65c02::State, sp));
+      e.Load8(RP, RCPU, NOREG, offsetof(W65c02::State, p));
+      e.PushMem(EDI, offsetof(Ctx, budget));
+      e.AluRR(OP_XOR, RCYC, RCYC);
+      loop_start = e.pos;
+
+      start = pc = from;
+      max_start = 0;
+      uint32_t max_cycles = 0;
+      bool terminated = false;
+      int n = 0;
+      for (; n < MAX_INSNS; n++)
+      {
+        opc = Peek(pc);
+        Op   op   = OPCODES[opc].op;
+        Mode mode = OPCODES[opc].mode;
+        int  len  = Length(op, mode);
+
+        // 命令バイトが RAM か ROM に収まっていること
+        uint32_t next = (uint32_t)pc + len;
+        if (!(next <= 0x8000 || (pc >= 0xF000 && next <= 0x10000))) break;
+
+        op8  = Peek(pc + 1);
+        op16 = op8 | (Peek(pc + 2) << 8);
+        if (!Supported(op, mode)) break;
+
+        uint32_t base = OPCODES[opc].cycles;
+        max_start = max_cycles;
+        max_cycles += base + ((mode == AXP || mode == AYP || mode == YIP) ? 1 : 0)
+                           + ((mode == REL) ? 2 : 0);
+
+        terminated = Emit(op, mode, base);
+
+        cycles    += base;
+        has_last   = true;
+        last_opc   = opc;
+        last_addr  = pc;
+        pc         = (uint16_t)next;
+        if (terminated) { n++; break; }
+        if (next == 0x10000) { n++; break; }
+      }
+      if (n == 0) return false;
+      end = (pc == 0) ? 0x10000 : pc;
+      if (!terminated) ExitBody(pc, cycles, has_last, last_opc, last_addr, false);
+
+      // 条件付きの出口
+      // (LoopBack が出口を追加するので添字で回し、要素はコピーする)
+      for (size_t i = 0; i < exits.size(); i++)
+      {
+        Exit x = exits[i];
+        e.Patch(x.at, e.pos);
+        if (x.loop) LoopBack(x.cycles, x.opc, x.opc_addr);
+        else        ExitBody(x.pc, x.cycles, x.has_last, x.opc, x.opc_addr, false);
+      }
+
+      // エピローグ: ゲスト状態を書き戻す (eax = サイクル数)
+      size_t epilogue = e.pos;
+      e.Store8(RCPU, NOREG, offsetof(W65c02::State, a),  RA);
+      e.Store8(RCPU, NOREG, offsetof(W65c02::State, x),  RX);
+      e.Store8(RCPU, NOREG, offsetof(W65c02::State, y),  RY);
+      e.Store8(RCPU, NOREG, offsetof(W65c02::State, sp), RS);
+      e.Store8(RCPU, NOREG, offsetof(W65c02::State, p),  RP);
+      e.Pop(ECX); // budget
+      e.Pop(R15); e.Pop(R14); e.Pop(R13); e.Pop(R12); e.Pop(EBP); e.Pop(EBX);
+      e.Ret();
+      for (size_t i = 0; i < to_epilogue.size(); i++) e.Patch(to_epilogue[i], epilogue);
+
+      return true;
+    }
+  };
+
+  // ---------------------------------------------------------------
+  //  キャッシュ管理
+  // ---------------------------------------------------------------
+
+  // 変換済みコードをすべて捨てる
+  static void Flush(System& sys)
+  {
+    State& jit = *sys.jit;
+    std::fill(jit.entry.begin(), jit.entry.end(), 0);
+    jit.blocks.clear();
+    for (int i = 0; i < 256; i++) jit.pages[i].clear();
+    jit.code_used = 0;
+    memset(sys.jit_code, 0, sizeof(sys.jit_code));
+  }
+
+  // pc から始まるブロックを変換 (戻り値は entry に入れる値、0 = 今回は変換しない)
+  static int32_t Translate(System& sys, uint16_t pc)
+  {
+    State& jit = *sys.jit;
+    if (jit.code_used + CODE_MARGIN > CODE_SIZE || jit.blocks.size() >= MAX_BLOCKS) Flush(sys);
+
+    Emitter em;
+    em.buf = jit.code;
+    em.pos = jit.code_used;
+    em.cap = CODE_SIZE;
+    Translator tr(sys, em);
+    uint32_t end = 0, max_start = 0;
+    if (!tr.Run(pc, end, max_start))
+    {
+      if (pc < 0x8000) sys.jit_code[pc] |= CODE_NOBLK;
+      return jit.entry[pc] = NO_BLOCK;
+    }
+    if (tr.e.overflow) { Flush(sys); return 0; }
+
+    Block b;
+    b.fn        = (BlockFn)(jit.code + jit.code_used);
+    b.start     = pc;
+    b.end       = end;
+    b.max_start = max_start;
+    b.valid     = true;
+    jit.code_used = tr.e.pos;
+
+    uint32_t id = (uint32_t)jit.blocks.size();
+    jit.blocks.push_back(b);
+    for (uint32_t page = b.start >> 8; page <= (b.end - 1) >> 8; page++) jit.pages[page].push_back(id);
+    for (uint32_t a = b.start; a < b.end && a < 0x8000; a++) sys.jit_code[a] |= CODE_BYTE;
+
+    return jit.entry[pc] = (int32_t)id + 1;
+  }
+
+  // 変換済みの命令バイトへの書き込み
+  void OnWrite(System& sys, uint16_t addr)
+  {
+    State& jit = *sys.jit;
+    uint8_t& mark = sys.jit_code[addr];
+
+    if (mark & CODE_NOBLK)
+    {
+      if (jit.entry[addr] == NO_BLOCK) jit.entry[addr] = 0;
+      mark &= ~CODE_NOBLK;
+    }
+    if (!(mark & CODE_BYTE)) return;
+
+    // このバイトを含むブロックを無効化
+    uint32_t lo = addr, hi = addr + 1;
+    std::vector<uint32_t>& list = jit.pages[addr >> 8];
+    for (size_t i = 0; i < list.size(); i++)
+    {
+      Block& b = jit.blocks[list[i]];
+      if (!b.valid || addr < b.start || addr >= b.end) continue;
+      b.valid = false;
+      jit.entry[b.start] = 0;
+      lo = std::min(lo, b.start);
+      hi = std::max(hi, b.end);
+    }
+
+    // 範囲内の印を残りのブロックから付け直す (無効なブロックはリストから除く)
+    for (uint32_t a = lo; a < hi; a++) sys.jit_code[a] &= ~CODE_BYTE;
+    for (uint32_t page = lo >> 8; page <= (hi - 1) >> 8; page++)
+    {
+      std::vector<uint32_t>& ids = jit.pages[page];
+      size_t keep = 0;
+      for (size_t i = 0; i < ids.size(); i++)
+      {
+        const Block& b = jit.blocks[ids[i]];
+        if (!b.valid) continue;
+        ids[keep++] = ids[i];
+        uint32_t from = std::max(b.start, lo), to = std::min(b.end, hi);
+        for (uint32_t a = from; a < to; a++) sys.jit_code[a] |= CODE_BYTE;
+      }
+      ids.resize(keep);
+    }
+  }
+
+  // ---------------------------------------------------------------
+  //  公開API
+  // ---------------------------------------------------------------
+
+  bool Init(System& sys)
+  {
+    if (!sys.jit)
+    {
+      void* mem = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mem == MAP_FAILED) return false;
+
+      State* jit = new State;
+      jit->code = (uint8_t*)mem;
+      jit->entry.assign(0x10000, 0);
+      for (int v = 0; v < 256; v++)
+        jit->nz[v] = (v & W65c02::FLAG_N) | (v ? 0 : W65c02::FLAG_Z);
+      sys.jit = jit;
+    }
+
+    State& jit = *sys.jit;
+    jit.ctx.ram  = sys.ram;
+    jit.ctx.rom  = sys.rom;
+    jit.ctx.nz   = jit.nz;
+    jit.ctx.code = sys.jit_code;
+    jit.ctx.cpu  = &sys.cpu;
+    Flush(sys);
+    return true;
+  }
+
+  void Shutdown(System& sys)
+  {
+    if (!sys.jit) return;
+    munmap(sys.jit->code, CODE_SIZE);
+    delete sys.jit;
+    sys.jit = nullptr;
+    memset(sys.jit_code, 0, sizeof(sys.jit_code));
+  }
+
+  void Run(System& sys, uint64_t target)
+  {
+    State&         jit = *sys.jit;
+    W65c02::State& cpu = sys.cpu;
+    Sched::State&  s   = sys.sched;
+    Cpu::Bus       bus{sys};
+
+    do
+    {
+      // 割り込み受付・WAI・STP・Tick 途中でなければブロックを探す
+      // (I フラグでマスクされた IRQ はブロックを止めない)
+      if (!(cpu.step | cpu.stp | cpu.wai | cpu.nmi) && !(cpu.irq && !(cpu.p & W65c02::FLAG_I)))
+      {
+        int32_t id = jit.entry[cpu.pc];
+        if (id == 0) id = Translate(sys, cpu.pc);
+        if (id > 0)
+        {
+          // ブロック内の全命令がインタプリタと同じ停止条件の範囲で始まるときだけ実行
+          // (先頭へのループも、次の周回がこの条件を満たす間だけ続ける)
+          const Block& b = jit.blocks[id - 1];
+          uint64_t last  = s.now + b.max_start;
+          uint64_t limit = std::min(target - 1, s.next_due);
+          if (last <= limit)
+          {
+            jit.ctx.budget = std::min<uint64_t>(limit - last, 0x7FFFFFFF);
+            uint32_t cycles = b.fn(&jit.ctx);
+            if (cycles) { s.now += cycles; continue; }
+          }
+        }
+      }
+      if (!W65c02::SkipWait(cpu, s.now, target, s.next_due)) s.now += W65c02::InstCycle(cpu, bus);
+    }
+    while (!cpu.stp && s.now < target && s.now <= s.next_due);
+  }
+
+}
+}
+
+#endif
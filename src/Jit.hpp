@@ -0,0 +1,42 @@
+/* src/Jit.hpp - 65C02 基本ブロック JIT (x86-64 Linux)
+ *
+ * RAM・ROM 上の命令列を基本ブロック単位で x86-64 のコードに変換して実行する。
+ *   - ブロックは分岐・ジャンプ・サブルーチン命令、または未対応命令の手前で終わる
+ *   - サイクル数はブロックの出口ごとに静的に積算 (ページ跨ぎ分だけ実行時に加算)
+ *   - ブロック先頭への分岐は、次のイベントまでの予算内ならブロック内でループする
+ *   - I/O 領域へのアクセスや10進モードの ADC/SBC はその命令の手前で抜け、インタプリタが実行する
+ *   - 受け付け可能な IRQ/NMI があるとき・WAI/STP 中はブロックに入らない (CLI・PLP でブロックを終える)
+ *   - 変換済み命令のバイトへの書き込みで、そのバイトを含むブロックを無効化する
+ *
+ * make JIT=1 でビルドに含まれ、実行時は EmulatorConfig::jit (jit=0 引数) で切り替える。
+ * 無効時や未対応命令ではネイティブの W65c02 インタプリタで実行する。
+ */
+#pragma once
+#include <cstdint>
+
+#if FXT_JIT && !(defined(__x86_64__) && defined(__linux__))
+#error "JIT=1 は x86-64 Linux のみ対応"
+#endif
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace Jit
+  {
+    // 変換キャッシュ (Jit.cpp 内で定義)
+    struct State;
+
+    // 初期化 (変換キャッシュを空にする)。実行領域を確保できなければ false
+    bool Init(System& sys);
+    // 解放
+    void Shutdown(System& sys);
+
+    // 命令を連続実行する (W65c02::Run と同じ停止条件)
+    void Run(System& sys, uint64_t target);
+
+    // 変換済みの命令バイトへ書き込まれた (sys.jit_code[addr] != 0 のときに呼ぶ)
+    void OnWrite(System& sys, uint16_t addr);
+  }
+}
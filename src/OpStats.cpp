@@ -0,0 +1,377 @@
+/* src/OpStats.cpp - オペコードごとの実行頻度とホスト実行コスト */
+#include "OpStats.hpp"
+
+#if FXT_OPSTATS
+#include "FxtSystem.hpp"
+#include "Cpu.hpp"
+#include "W65c02.hpp" // 命令表 (vremu コアでも名前・モードの表示に使う)
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#  define FXT_OPSTATS_RDTSC 1
+#else
+#  define FXT_OPSTATS_RDTSC 0
+#endif
+
+namespace Fxt
+{
+namespace OpStats
+{
+  static constexpr int TOP_OPS = 16; // 要約に出すオペコードの数
+
+  static const char* const OP_NAMES[] = {
+    "ADC", "AND", "ASL", "BBR", "BBS", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL", "BRA", "BRK",
+    "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR", "INC",
+    "INX", "INY", "JMP", "JSR", "LDA", "LDD", "LDX", "LDY", "LSR", "NOP", "ORA", "PHA", "PHP", "PHX",
+    "PHY", "PLA", "PLP", "PLX", "PLY", "RMB", "ROL", "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI",
+    "SMB", "STA", "STP", "STX", "STY", "STZ", "TAX", "TAY", "TRB", "TSB", "TSX", "TXA", "TXS", "TYA",
+    "WAI",
+  };
+
+  // W65c02::Mode の表記 (ページ跨ぎの有無は区別しない)
+  static const char* const MODE_NAMES[] = {
+    "imp", "A", "#imm", "zp", "zp,x", "zp,y", "(zp)", "(zp,x)", "(zp),y", "(zp),y",
+    "abs", "abs,x", "abs,y", "abs,x", "abs,y", "(abs)", "(abs,x)", "rel",
+  };
+
+  // 1行分 (オペコード・割り込み受付・待機)
+  struct Row
+  {
+    uint64_t count   = 0; // 実行回数
+    uint64_t cycles  = 0; // ゲストサイクル数
+    uint64_t samples = 0; // ホスト時間を計った回数
+    uint64_t ticks   = 0; // その合計 [カウンタ値]
+  };
+
+  // 命令の置き場所
+  enum Region : uint8_t { RAM, ROM, OTHER, REGION_COUNT };
+  static const char* const REGION_NAMES[REGION_COUNT] = {"ram", "rom", "other"};
+
+  struct State
+  {
+    Row ops[256];
+    Row irq;  // 割り込み受付 (IRQ / NMI)
+    Row wait; // WAI / STP の待機
+    uint64_t region_cycles[REGION_COUNT] = {};
+    uint64_t region_insns[REGION_COUNT]  = {};
+
+    int      sample    = 16; // この命令数に1回計る
+    int      countdown = 1;
+    uint64_t start     = 0;  // 計測開始時の sched.now
+    uint64_t overhead  = 0;  // 計測そのもののコスト (空の区間の最小値) [カウンタ値]
+    uint64_t tick0     = 0;  // 開始時のカウンタ値と時刻 (カウンタ値 → ns の換算用)
+    std::chrono::steady_clock::time_point time0;
+  };
+
+  // タイムスタンプカウンタ (rdtsc が無ければ ns)
+  static inline uint64_t Ticks()
+  {
+#if FXT_OPSTATS_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  static uint8_t PeekOpcode(const System& sys, uint16_t pc)
+  {
+    if (pc < 0x8000)  return sys.ram[pc];
+    if (pc >= 0xF000) return sys.rom[pc & 0x0FFF];
+    return 0xFF;
+  }
+
+  // 表示名 (RMB / SMB / BBR / BBS はビット番号付き)
+  static std::string OpName(uint8_t opc)
+  {
+    const W65c02::Opcode& o = W65c02::OPCODES[opc];
+    std::string name = OP_NAMES[o.op];
+    if (o.op == W65c02::RMB || o.op == W65c02::SMB || o.op == W65c02::BBR || o.op == W65c02::BBS)
+      name += (char)('0' + ((opc >> 4) & 7));
+    return name;
+  }
+
+  static const char* ModeName(uint8_t opc)
+  {
+    const W65c02::Opcode& o = W65c02::OPCODES[opc];
+    if (o.op == W65c02::BBR || o.op == W65c02::BBS) return "zp,rel";
+    return MODE_NAMES[o.mode];
+  }
+
+  void Start(System& sys, int sample)
+  {
+    if (!sys.opstats) sys.opstats = new State();
+    State& st = *sys.opstats;
+    st = State();
+    st.sample    = sample > 0 ? sample : 1;
+    st.countdown = 1;
+    st.start     = sys.sched.now;
+
+    // 何もしない区間を計って、1回の計測に上乗せされる分とする
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++)
+    {
+      uint64_t t0 = Ticks();
+      uint64_t t1 = Ticks();
+      best = std::min(best, t1 - t0);
+    }
+    st.overhead = best;
+    st.tick0    = Ticks();
+    st.time0    = std::chrono::steady_clock::now();
+  }
+
+  void Stop(System& sys)
+  {
+    delete sys.opstats;
+    sys.opstats = nullptr;
+  }
+
+  uint8_t Step(System& sys)
+  {
+    State&    st     = *sys.opstats;
+    Cpu::Regs before = Cpu::GetRegs(sys);
+    uint8_t   opc    = PeekOpcode(sys, before.pc);
+
+    bool     timed = --st.countdown == 0;
+    uint64_t t0    = timed ? Ticks() : 0;
+    uint8_t  cycles = Cpu::InstCycle(sys);
+    uint64_t dt    = timed ? Ticks() - t0 : 0;
+    if (timed) st.countdown = st.sample;
+
+    Cpu::Regs after = Cpu::GetRegs(sys);
+    Row* row;
+    if (cycles == 1 && after.pc == before.pc && after.sp == before.sp)
+    {
+      // WAI / STP で止まっている (1サイクルで PC の進まない命令は無い)
+      row = &st.wait;
+    }
+    else if (after.sp == (uint8_t)(before.sp - 3) &&
+             !(sys.ram[0x100 | (uint8_t)(after.sp + 1)] & W65c02::FLAG_B))
+    {
+      // 割り込み受付 (SP が3減るのは BRK と割り込みだけで、積んだ P の B で見分ける)
+      row = &st.irq;
+    }
+    else
+    {
+      row = &st.ops[opc];
+      Region r = before.pc < 0x8000 ? RAM : before.pc >= 0xF000 ? ROM : OTHER;
+      st.region_cycles[r] += cycles;
+      st.region_insns[r]++;
+    }
+    row->count++;
+    row->cycles += cycles;
+    if (timed)
+    {
+      row->samples++;
+      row->ticks += dt;
+    }
+    return cycles;
+  }
+
+  // 集計済みの1行 (表示用)
+  struct Line
+  {
+    std::string name;
+    std::string mode;
+    int         opcode   = -1; // -1 = 割り込み受付・待機・モードの行
+    Row         row;
+    double      ns_avg   = 0;  // 1回あたりのホスト時間 [ns]
+    double      ns_total = 0;  // 推定合計 (ns_avg × 実行回数) [ns]
+  };
+
+  static void Finish(Line& l, uint64_t overhead, double ns_per_tick)
+  {
+    const Row& r = l.row;
+    double ticks = r.samples ? (double)r.ticks / r.samples - (double)overhead : 0.0;
+    l.ns_avg   = std::max(ticks, 0.0) * ns_per_tick;
+    l.ns_total = l.ns_avg * r.count;
+  }
+
+  // "$A9"、割り込み受付・待機は "-"
+  static std::string OpcodeLabel(const Line& l)
+  {
+    if (l.opcode < 0) return "-";
+    char buf[4];
+    snprintf(buf, sizeof(buf), "$%02X", (unsigned)(uint8_t)l.opcode);
+    return buf;
+  }
+
+  static FILE* OpenOut(const std::string& path, FILE* log)
+  {
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp) fprintf(log, "[OpStats] Error: %s を書き出せません\n", path.c_str());
+    return fp;
+  }
+
+  // CSV と JSON の配列に行を書く
+  static void WriteLines(FILE* csv, FILE* json, const std::vector<Line>& lines, bool with_opcode,
+                         uint64_t total_count, uint64_t total_cycles, double total_ns)
+  {
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      const Line& l = lines[i];
+      const Row&  r = l.row;
+      double count_pct  = total_count  ? 100.0 * r.count / total_count   : 0.0;
+      double cycles_pct = total_cycles ? 100.0 * r.cycles / total_cycles : 0.0;
+      double ns_pct     = total_ns > 0 ? 100.0 * l.ns_total / total_ns   : 0.0;
+      std::string opcode = OpcodeLabel(l);
+
+      if (with_opcode) fprintf(csv, "%s,%s,", opcode.c_str(), l.name.c_str());
+      fprintf(csv, "%s,%" PRIu64 ",%.4f,%" PRIu64 ",%.4f,%" PRIu64 ",%.2f,%.0f,%.4f\n",
+              l.mode.c_str(), r.count, count_pct, r.cycles, cycles_pct, r.samples,
+              l.ns_avg, l.ns_total, ns_pct);
+
+      fprintf(json, "    {");
+      if (with_opcode) fprintf(json, "\"opcode\": \"%s\", \"mnemonic\": \"%s\", ", opcode.c_str(), l.name.c_str());
+      fprintf(json, "\"mode\": \"%s\", \"count\": %" PRIu64 ", \"count_pct\": %.4f, \"cycles\": %" PRIu64
+                    ", \"cycles_pct\": %.4f, \"samples\": %" PRIu64 ", \"ns_avg\": %.2f, \"ns_total\": %.0f"
+                    ", \"ns_pct\": %.4f}%s\n",
+              l.mode.c_str(), r.count, count_pct, r.cycles, cycles_pct, r.samples,
+              l.ns_avg, l.ns_total, ns_pct, i + 1 < lines.size() ? "," : "");
+    }
+  }
+
+  bool Dump(const System& sys, const std::string& base, FILE* log)
+  {
+    if (!sys.opstats) return false;
+    const State& st = *sys.opstats;
+
+    // カウンタ値 → ns
+    double elapsed_ns  = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - st.time0).count();
+    uint64_t elapsed_t = Ticks() - st.tick0;
+    double ns_per_tick = elapsed_t ? elapsed_ns / elapsed_t : 1.0;
+
+    // オペコードごと (実行されたものだけ) と、アドレッシングモードごと
+    std::vector<Line> ops;
+    std::map<std::string, Line> modes;
+    for (int opc = 0; opc < 256; opc++)
+    {
+      const Row& r = st.ops[opc];
+      if (!r.count) continue;
+      Line l;
+      l.name   = OpName((uint8_t)opc);
+      l.mode   = ModeName((uint8_t)opc);
+      l.opcode = opc;
+      l.row    = r;
+      Finish(l, st.overhead, ns_per_tick);
+      ops.push_back(l);
+
+      // モードの平均は各オペコードの推定時間の合計から求める
+      Line& m = modes[l.mode];
+      m.mode  = l.mode;
+      m.row.count   += r.count;
+      m.row.cycles  += r.cycles;
+      m.row.samples += r.samples;
+      m.ns_total    += l.ns_total;
+    }
+    const Row*  extra[]      = {&st.irq, &st.wait};
+    const char* extra_name[] = {"(interrupt)", "(wait)"};
+    for (int i = 0; i < 2; i++)
+    {
+      if (!extra[i]->count) continue;
+      Line l;
+      l.name   = extra_name[i];
+      l.mode   = "-";
+      l.opcode = -1;
+      l.row    = *extra[i];
+      Finish(l, st.overhead, ns_per_tick);
+      ops.push_back(l);
+    }
+
+    uint64_t total_count = 0, total_cycles = 0;
+    double   total_ns = 0;
+    for (const Line& l : ops)
+    {
+      total_count  += l.row.count;
+      total_cycles += l.row.cycles;
+      total_ns     += l.ns_total;
+    }
+    auto by_ns = [](const Line& a, const Line& b)
+    { return a.ns_total != b.ns_total ? a.ns_total > b.ns_total : a.row.count > b.row.count; };
+    std::sort(ops.begin(), ops.end(), by_ns);
+
+    std::vector<Line> mode_lines;
+    for (auto& m : modes)
+    {
+      Line& l = m.second;
+      l.ns_avg = l.row.count ? l.ns_total / l.row.count : 0.0;
+      mode_lines.push_back(l);
+    }
+    std::sort(mode_lines.begin(), mode_lines.end(), by_ns);
+
+    std::string csv_path   = base + ".csv";
+    std::string modes_path = base + ".modes.csv";
+    std::string json_path  = base + ".json";
+    FILE* csv   = OpenOut(csv_path, log);
+    FILE* mcsv  = csv  ? OpenOut(modes_path, log) : nullptr;
+    FILE* json  = mcsv ? OpenOut(json_path, log)  : nullptr;
+    if (!json)
+    {
+      if (csv)  fclose(csv);
+      if (mcsv) fclose(mcsv);
+      return false;
+    }
+
+    uint64_t insn_cycles = 0;
+    for (int r = 0; r < REGION_COUNT; r++) insn_cycles += st.region_cycles[r];
+
+    fprintf(json, "{\n  \"core\": \"%s\",\n  \"start_cycle\": %" PRIu64 ",\n  \"end_cycle\": %" PRIu64 ",\n"
+                  "  \"count\": %" PRIu64 ",\n  \"cycles\": %" PRIu64 ",\n  \"ns_total\": %.0f,\n"
+                  "  \"sample_every\": %d,\n  \"timer\": \"%s\",\n  \"ns_per_tick\": %.6f,\n"
+                  "  \"overhead_ticks\": %" PRIu64 ",\n  \"regions\": {\n",
+#if FXT_CPU_VREMU
+            "vremu",
+#else
+            "native",
+#endif
+            st.start, sys.sched.now, total_count, total_cycles, total_ns, st.sample,
+            FXT_OPSTATS_RDTSC ? "rdtsc" : "steady_clock", ns_per_tick, st.overhead);
+    for (int r = 0; r < REGION_COUNT; r++)
+      fprintf(json, "    \"%s\": {\"insns\": %" PRIu64 ", \"cycles\": %" PRIu64 ", \"cycles_pct\": %.4f}%s\n",
+              REGION_NAMES[r], st.region_insns[r], st.region_cycles[r],
+              insn_cycles ? 100.0 * st.region_cycles[r] / insn_cycles : 0.0, r + 1 < REGION_COUNT ? "," : "");
+
+    fprintf(csv, "opcode,mnemonic,mode,count,count_pct,cycles,cycles_pct,samples,ns_avg,ns_total,ns_pct\n");
+    fprintf(json, "  },\n  \"opcodes\": [\n");
+    WriteLines(csv, json, ops, true, total_count, total_cycles, total_ns);
+
+    fprintf(mcsv, "mode,count,count_pct,cycles,cycles_pct,samples,ns_avg,ns_total,ns_pct\n");
+    fprintf(json, "  ],\n  \"modes\": [\n");
+    WriteLines(mcsv, json, mode_lines, false, total_count, total_cycles, total_ns);
+    fprintf(json, "  ]\n}\n");
+
+    fclose(csv);
+    fclose(mcsv);
+    fclose(json);
+
+    // 要約
+    fprintf(log, "[OpStats] %" PRIu64 " steps, %" PRIu64 " cycles, %.1f ms host (est.) -> %s.{csv,modes.csv,json}\n",
+            total_count, total_cycles, total_ns * 1e-6, base.c_str());
+    fprintf(log, "[OpStats] code in ROM %.1f%% / RAM %.1f%% of instruction cycles\n",
+            insn_cycles ? 100.0 * st.region_cycles[ROM] / insn_cycles : 0.0,
+            insn_cycles ? 100.0 * st.region_cycles[RAM] / insn_cycles : 0.0);
+    fprintf(log, "[OpStats] %-4s %-12s %-8s %12s %7s %8s %7s\n", "op", "mnemonic", "mode", "count", "count%", "ns/op", "ns%");
+    for (size_t i = 0; i < ops.size() && i < (size_t)TOP_OPS; i++)
+    {
+      const Line& l = ops[i];
+      fprintf(log, "[OpStats] %-4s %-12s %-8s %12" PRIu64 " %7.2f %8.2f %7.2f\n",
+              OpcodeLabel(l).c_str(), l.name.c_str(), l.mode.c_str(), l.row.count,
+              total_count ? 100.0 * l.row.count / total_count : 0.0,
+              l.ns_avg, total_ns > 0 ? 100.0 * l.ns_total / total_ns : 0.0);
+    }
+    return true;
+  }
+
+} // namespace OpStats
+} // namespace Fxt
+#endif // FXT_OPSTATS
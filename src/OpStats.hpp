@@ -0,0 +1,50 @@
+/* src/OpStats.hpp - オペコードごとの実行頻度とホスト実行コスト (計測ビルド)
+ *
+ * CPU コアの最適化対象を決めるための統計。計測中は RunCycles が1命令ずつ Cpu::InstCycle を呼び、
+ *   - オペコード (256 種) ごとの実行回数・ゲストサイクル数
+ *   - N 命令に1回、InstCycle の前後で読んだタイムスタンプカウンタ (x86 は rdtsc、
+ *     それ以外は steady_clock) の差 = 1命令のホスト実行コスト
+ *   - 命令の置き場所 (ROM $F000- / RAM $0000-$7FFF / それ以外) ごとのサイクル数
+ * を数える。割り込み受付と WAI / STP の待機はオペコードとは別の行にする。
+ * 計るのはインタプリタの1命令実行 (vrEmu6502 では vrEmu6502InstCycle、native では
+ * W65c02::InstCycle のディスパッチ) で、JIT・トレースキャッシュ・ROM 事前変換・待機ループの省略は使わない。
+ * I/O ハンドラ (デバイス側の処理) の時間は、それを呼んだ命令のコストに含まれる。
+ *
+ * OPSTATS=1 ビルド (FXT_OPSTATS=1) でのみ組み込まれる。ホットスポット計測と同時に開始したときは
+ * こちらを優先し、ホットスポットには数えない。
+ * Dump はオペコードごとの表 (base.csv)、アドレッシングモードごとの表 (base.modes.csv)、
+ * 両方と ROM / RAM の内訳を含む JSON (base.json) を、推定ホスト時間の多い順に書き出す。
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#ifndef FXT_OPSTATS
+#  define FXT_OPSTATS 0
+#endif
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace OpStats
+  {
+    // カウンタ本体 (OpStats.cpp 内で定義)
+    struct State;
+
+#if FXT_OPSTATS
+    // 計測開始 (sample 命令に1回ホスト時間を計る。1 ならすべて)
+    void Start(System& sys, int sample = 16);
+    // 計測終了 (カウンタを解放する)
+    void Stop(System& sys);
+
+    // 1命令を実行してカウンタに積み、消費サイクル数を返す (RunCycles から呼ぶ)
+    uint8_t Step(System& sys);
+
+    // base.csv / base.modes.csv / base.json を書き出し、要約を log へ (計測中のみ)
+    bool Dump(const System& sys, const std::string& base, FILE* log = stderr);
+#endif
+  }
+}
@@ -0,0 +1,263 @@
+/* src/Prof.cpp - SIGPROF によるサンプリングプロファイラ */
+#include "Prof.hpp"
+
+#if FXT_PROF
+#include "FxtSystem.hpp"
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <csignal>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+namespace Fxt
+{
+namespace Prof
+{
+  static constexpr int      MAX_DEPTH   = 8;       // ゾーンの入れ子の上限 (超えた分は記録しない)
+  static constexpr uint32_t MAX_SAMPLES = 1 << 20; // これ以上は数えるだけで捨てる
+  static constexpr int      TOP_PCS     = 20;      // フラットプロファイルに出すゲスト PC の数
+
+  static const char* const ZONE_NAMES[ZONE_COUNT] = {
+    "(other)", "CPU", "VIA", "PS2", "PSG", "RenderFrame", "texture", "ImGui",
+  };
+
+  // スレッドごとのゾーンスタック (シグナルハンドラから読む)
+  struct Context
+  {
+    volatile uint8_t    depth;
+    volatile uint8_t    stack[MAX_DEPTH];
+    const System* volatile sys; // CPU ゾーンの System
+    const char* volatile   name;
+  };
+  static thread_local Context t_ctx;
+
+  // 1サンプル
+  struct Sample
+  {
+    const char* thread;
+    uint8_t     depth;
+    uint8_t     stack[MAX_DEPTH];
+    bool        has_pc;
+    uint16_t    pc;
+  };
+
+  static Sample*               g_samples = nullptr;
+  static std::atomic<uint32_t> g_count{0};
+  static std::atomic<bool>     g_running{false};
+  static std::string           g_path;
+  static int                   g_hz = 0;
+  static double                g_cpu_start = 0; // 開始時のプロセス CPU 時間 [s]
+  static struct sigaction      g_old_action;
+
+  // プロセスの CPU 時間 (全スレッドの user + sys) [s]
+  static double CpuSeconds()
+  {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+  }
+
+  // SIGPROF ハンドラ (非同期シグナル安全な処理のみ)
+  static void OnSignal(int)
+  {
+    uint32_t i = g_count.fetch_add(1, std::memory_order_relaxed);
+    if (i >= MAX_SAMPLES) return;
+
+    const Context& c = t_ctx;
+    Sample&        s = g_samples[i];
+    uint8_t depth = c.depth;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    s.thread = c.name;
+    s.depth  = depth;
+    s.has_pc = false;
+    for (int d = 0; d < depth; d++)
+    {
+      s.stack[d] = c.stack[d];
+      if (s.stack[d] == CPU && c.sys) s.has_pc = true;
+    }
+    if (s.has_pc) s.pc = Cpu::GetPC(*c.sys);
+  }
+
+  Scope::Scope(Zone zone, const System* sys)
+  {
+    Context& c = t_ctx;
+    uint8_t d = c.depth;
+    if (d < MAX_DEPTH)
+    {
+      c.stack[d] = zone;
+      if (sys) c.sys = sys;
+    }
+    // 書き込みの後で深さを公開する (ハンドラは同じスレッドで割り込むのでコンパイラの順序だけ守る)
+    std::atomic_signal_fence(std::memory_order_release);
+    c.depth = d + 1;
+  }
+
+  Scope::~Scope()
+  {
+    Context& c = t_ctx;
+    c.depth = c.depth - 1;
+  }
+
+  void SetThreadName(const char* name)
+  {
+    t_ctx.name = name;
+  }
+
+  bool Running()
+  {
+    return g_running.load(std::memory_order_acquire);
+  }
+
+  bool Start(const char* path, int hz)
+  {
+    if (Running()) return false;
+    if (hz <= 0) hz = 1000;
+    if (!t_ctx.name) t_ctx.name = "main";
+
+    if (!g_samples) g_samples = new Sample[MAX_SAMPLES];
+    g_count.store(0, std::memory_order_relaxed);
+    g_path = path;
+    g_hz   = hz;
+
+    struct sigaction sa = {};
+    sa.sa_handler = OnSignal;
+    sa.sa_flags   = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, &g_old_action) != 0)
+    {
+      perror("[Prof] sigaction");
+      return false;
+    }
+
+    struct itimerval it = {};
+    it.it_interval.tv_sec  = 0;
+    it.it_interval.tv_usec = hz >= 1000000 ? 1 : 1000000 / hz;
+    it.it_value            = it.it_interval;
+    if (setitimer(ITIMER_PROF, &it, nullptr) != 0)
+    {
+      perror("[Prof] setitimer");
+      sigaction(SIGPROF, &g_old_action, nullptr);
+      return false;
+    }
+    g_cpu_start = CpuSeconds();
+    g_running.store(true, std::memory_order_release);
+    return true;
+  }
+
+  // folded stacks の1行分のキー
+  static std::string FoldedKey(const Sample& s, const Symbols::Table* syms)
+  {
+    std::string key = s.thread ? s.thread : "?";
+    if (s.depth == 0)
+    {
+      key += ';';
+      key += ZONE_NAMES[NONE];
+    }
+    for (int d = 0; d < s.depth; d++)
+    {
+      key += ';';
+      key += ZONE_NAMES[s.stack[d]];
+    }
+    if (s.has_pc)
+    {
+      char buf[8];
+      snprintf(buf, sizeof(buf), ";$%04X", s.pc);
+      key += buf;
+      std::string name = syms ? Symbols::Format(*syms, s.pc) : std::string();
+      if (!name.empty()) key += ' ' + name;
+    }
+    return key;
+  }
+
+  void Stop(FILE* fp, const Symbols::Table* syms)
+  {
+    if (!Running()) return;
+
+    struct itimerval it = {};
+    setitimer(ITIMER_PROF, &it, nullptr);
+    // 配送待ちの SIGPROF が既定動作 (終了) にならないよう、元が既定なら無視にする
+    if (g_old_action.sa_handler == SIG_DFL && !(g_old_action.sa_flags & SA_SIGINFO))
+      signal(SIGPROF, SIG_IGN);
+    else
+      sigaction(SIGPROF, &g_old_action, nullptr);
+    g_running.store(false, std::memory_order_release);
+
+    // タイマの分解能 (カーネルの tick) で実際の周期は指定より長くなることがあるので、
+    // 1サンプルの重みは計測中の CPU 時間をサンプル数で割って求める
+    double   cpu_ms  = (CpuSeconds() - g_cpu_start) * 1000.0;
+    uint32_t total   = g_count.load(std::memory_order_relaxed);
+    uint32_t n       = std::min(total, MAX_SAMPLES);
+    double   ms_each = total ? cpu_ms / total : 1000.0 / g_hz;
+
+    // 集計
+    uint64_t self[ZONE_COUNT]  = {};
+    uint64_t incl[ZONE_COUNT]  = {};
+    std::vector<uint32_t>               pc_count(0x10000, 0);
+    std::map<std::string, uint32_t>     folded;
+    for (uint32_t i = 0; i < n; i++)
+    {
+      const Sample& s = g_samples[i];
+      Zone leaf = s.depth ? (Zone)s.stack[s.depth - 1] : NONE;
+      self[leaf]++;
+      bool seen[ZONE_COUNT] = {};
+      if (!s.depth) seen[NONE] = true;
+      for (int d = 0; d < s.depth; d++) seen[s.stack[d]] = true;
+      for (int z = 0; z < ZONE_COUNT; z++) if (seen[z]) incl[z]++;
+      if (s.has_pc && leaf == CPU) pc_count[s.pc]++;
+      folded[FoldedKey(s, syms)]++;
+    }
+
+    // フラットプロファイル
+    fprintf(fp, "[Prof] %u samples in %.0f ms CPU (%.2f ms each, requested %d Hz)",
+            n, cpu_ms, ms_each, g_hz);
+    if (total > n) fprintf(fp, ", %u dropped", total - n);
+    fprintf(fp, "\n[Prof] %-12s %10s %7s %10s %7s\n", "zone", "self ms", "self%", "total ms", "total%");
+    for (int z = 0; z < ZONE_COUNT; z++)
+    {
+      if (!incl[z]) continue;
+      fprintf(fp, "[Prof] %-12s %10.1f %7.1f %10.1f %7.1f\n", ZONE_NAMES[z],
+              self[z] * ms_each, n ? 100.0 * self[z] / n : 0.0,
+              incl[z] * ms_each, n ? 100.0 * incl[z] / n : 0.0);
+    }
+
+    std::vector<std::pair<uint32_t, int>> pcs;
+    for (int pc = 0; pc < 0x10000; pc++)
+      if (pc_count[pc]) pcs.push_back(std::make_pair(pc_count[pc], pc));
+    std::sort(pcs.begin(), pcs.end(), [](const std::pair<uint32_t, int>& a, const std::pair<uint32_t, int>& b)
+              { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    if (!pcs.empty())
+    {
+      fprintf(fp, "[Prof] %-12s %10s %7s   (CPU self)\n", "guest PC", "ms", "%");
+      for (size_t i = 0; i < pcs.size() && i < (size_t)TOP_PCS; i++)
+      {
+        std::string name = syms ? Symbols::Format(*syms, (uint16_t)pcs[i].second) : std::string();
+        fprintf(fp, "[Prof] $%04X        %10.1f %7.1f  %s\n", pcs[i].second,
+                pcs[i].first * ms_each, n ? 100.0 * pcs[i].first / n : 0.0, name.c_str());
+      }
+    }
+
+    // folded stacks
+    FILE* out = fopen(g_path.c_str(), "w");
+    if (!out)
+    {
+      fprintf(fp, "[Prof] Error: %s を書き出せません\n", g_path.c_str());
+      return;
+    }
+    for (const auto& f : folded)
+      fprintf(out, "%s %u\n", f.first.c_str(), f.second);
+    fclose(out);
+    fprintf(fp, "[Prof] folded stacks: %s\n", g_path.c_str());
+  }
+
+} // namespace Prof
+} // namespace Fxt
+#endif // FXT_PROF
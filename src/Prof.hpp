@@ -0,0 +1,82 @@
+/* src/Prof.hpp - SIGPROF によるサンプリングプロファイラ
+ *
+ * setitimer(ITIMER_PROF) で一定の CPU 時間ごとに SIGPROF を受け、割り込まれたスレッドが
+ * どのサブシステム (ゾーン) を実行中だったかと、そのときのゲスト PC を記録する。
+ *   - ゾーンは FXT_PROF_ZONE で囲んだ範囲 (入れ子可)。スレッドごとのスタックに積む
+ *   - CPU ゾーンに入るときに System を渡しておくと、サンプルにゲスト PC を含める
+ *     (JIT 実行中は直前にインタプリタ・ブロック境界で書き戻された PC になる)
+ *   - シグナルハンドラは確保済みのバッファに追記するだけで、集計は Stop で行う
+ * Stop でフラットプロファイル (ゾーン別の自己・累積時間、ゲスト PC 上位) を出力し、
+ * フレームグラフ用の folded stacks ("スレッド;ゾーン;...;$PC 回数") をファイルに書く。
+ * シンボル表を渡すと、ゲスト PC を "$PC name+$off" のように併記する。
+ *
+ * PROF=1 ビルド (FXT_PROF=1) でのみ組み込まれ、それ以外では FXT_PROF_ZONE は何も生成しない。
+ * setitimer の使えない Windows・Emscripten では常に無効。
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+#include "Symbols.hpp"
+
+#ifndef FXT_PROF
+#  define FXT_PROF 0
+#endif
+#if FXT_PROF && (defined(_WIN32) || defined(__EMSCRIPTEN__))
+#  undef  FXT_PROF
+#  define FXT_PROF 0
+#endif
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace Prof
+  {
+    // サブシステム
+    enum Zone : uint8_t
+    {
+      NONE,    // どのゾーンにも入っていない
+      CPU,     // 命令実行 (RunCycles)
+      VIA,     // VIA レジスタアクセス・タイマ・VBLANK
+      PS2,     // PS/2 キー入力・クロック
+      PSG,     // PSG レジスタアクセス・音声合成
+      RENDER,  // Chdz::RenderFrame
+      TEXTURE, // テクスチャ転送
+      IMGUI,   // ImGui フレーム構築・描画
+      ZONE_COUNT
+    };
+
+#if FXT_PROF
+    // 開始: path に folded stacks を書く。hz はサンプリング周波数 [Hz]
+    bool Start(const char* path, int hz = 1000);
+    // 停止して集計を出力 (フラットプロファイルは fp へ。syms があれば PC にシンボル名を添える)
+    void Stop(FILE* fp = stderr, const Symbols::Table* syms = nullptr);
+    // 実行中か
+    bool Running();
+
+    // 呼び出しスレッドの名前 (folded stacks の根。既定 "main")
+    void SetThreadName(const char* name);
+
+    // ゾーンの範囲 (スレッドごとのスタックに積む)
+    struct Scope
+    {
+      explicit Scope(Zone zone, const System* sys = nullptr);
+      ~Scope();
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+    };
+#endif
+  }
+}
+
+#if FXT_PROF
+#  define FXT_PROF_CAT2(a, b) a##b
+#  define FXT_PROF_CAT(a, b)  FXT_PROF_CAT2(a, b)
+// ゾーン名は Prof::Zone の列挙子。CPU では System を第2引数に渡すとゲスト PC を記録する
+#  define FXT_PROF_ZONE(...) \
+     ::Fxt::Prof::Scope FXT_PROF_CAT(fxt_prof_zone_, __LINE__)(::Fxt::Prof::__VA_ARGS__)
+#else
+#  define FXT_PROF_ZONE(...) ((void)0)
+#endif
@@ -5,6 +5,7 @@
 #include "Ps2.hpp"
 #include "FxtSystem.hpp"
 #include "Via.hpp"
+#include "Prof.hpp"
 
 //#define PS2_DEBUG 1
 #if PS2_DEBUG
@@ -161,21 +162,27 @@ static void queue_byte(State& ps2, uint8_t b)
 // ---------------------------------------------------------------
 //  KeyDown / KeyUp
 // ---------------------------------------------------------------
-void KeyDown(State& ps2, int sapp_keycode)
+void KeyDown(Fxt::System& sys, int sapp_keycode)
 {
+  FXT_PROF_ZONE(PS2);
   Ps2Key k = keycode_to_ps2(sapp_keycode);
   if (k.code == 0) return;
-  if (k.extended) queue_byte(ps2, 0xE0);
-  queue_byte(ps2, k.code);
+  Sync(sys, sys.sched.now);
+  if (k.extended) queue_byte(sys.ps2, 0xE0);
+  queue_byte(sys.ps2, k.code);
+  Reschedule(sys);
 }
 
-void KeyUp(State& ps2, int sapp_keycode)
+void KeyUp(Fxt::System& sys, int sapp_keycode)
 {
+  FXT_PROF_ZONE(PS2);
   Ps2Key k = keycode_to_ps2(sapp_keycode);
   if (k.code == 0) return;
-  if (k.extended) queue_byte(ps2, 0xE0);
-  queue_byte(ps2, 0xF0);
-  queue_byte(ps2, k.code);
+  Sync(sys, sys.sched.now);
+  if (k.extended) queue_byte(sys.ps2, 0xE0);
+  queue_byte(sys.ps2, 0xF0);
+  queue_byte(sys.ps2, k.code);
+  Reschedule(sys);
 }
 
 // ---------------------------------------------------------------
@@ -190,9 +197,10 @@ uint8_t GetPortBBits(const State& ps2)
 }
 
 // ---------------------------------------------------------------
-//  Tick - 1CPUサイクル分のPS/2ステートマシン実行
+//  Step - 1CPUサイクル分のPS/2ステートマシン実行
+//  状態変化が起きるサイクルでのみ呼ばれる (それ以外は Skip で一括処理)
 // ---------------------------------------------------------------
-void Tick(Fxt::System& sys)
+static void Step(Fxt::System& sys)
 {
   State&            ps2 = sys.ps2;
   const Fxt::Via::State& via = sys.via;
@@ -205,15 +213,6 @@ void Tick(Fxt::System& sys)
   {
     if (host_clk_low) // ホストがクロックをLow: Inhibit
     {
-#if PS2_DEBUG
-      if (ps2.q_head != ps2.q_tail) {
-        static int inhibit_cnt = 0;
-        if (++inhibit_cnt % 50000 == 0)
-          PS2_LOG("STALL: Inhibit継続中 queue=%d tx_delay=%d DDRB=%02X ORB=%02X\n",
-                  (ps2.q_tail - ps2.q_head + QUEUE_SIZE) % QUEUE_SIZE,
-                  ps2.tx_delay_cnt, via.reg_ddrb, via.reg_orb);
-      }
-#endif
       ps2.clk = true;
       ps2.dat = true;
       ps2.tx_delay_cnt = 400;
@@ -356,4 +355,101 @@ void Tick(Fxt::System& sys)
   }
 }
 
+// ---------------------------------------------------------------
+//  ホストのライン状態判定
+// ---------------------------------------------------------------
+static bool HostClkLow(const Fxt::Via::State& via)
+{
+  return (via.reg_ddrb & CLK_BIT) && !(via.reg_orb & CLK_BIT);
+}
+
+static bool HostDatLow(const Fxt::Via::State& via)
+{
+  return (via.reg_ddrb & DAT_BIT) && !(via.reg_orb & DAT_BIT);
+}
+
+// ---------------------------------------------------------------
+//  NextStep - 次に Step を実行すべきサイクル (状態変化が起きるサイクル)
+//  ホスト側ライン・キューが変わらない限り、それまでのサイクルは
+//  カウンタが減るだけで状態は変化しない
+// ---------------------------------------------------------------
+static uint64_t NextStep(const Fxt::System& sys)
+{
+  const State& ps2 = sys.ps2;
+
+  if (ps2.phase == Phase::IDLE)
+  {
+    if (HostClkLow(sys.via)) return Fxt::Sched::NEVER; // Inhibit 中は待機のみ
+    if (HostDatLow(sys.via)) return ps2.sync_cycle;     // RTS: 即座に受信開始
+    if (ps2.q_head != ps2.q_tail)                        // 送信待ち: 遅延明けに開始
+      return ps2.sync_cycle + (ps2.tx_delay_cnt > 0 ? ps2.tx_delay_cnt : 0);
+    return Fxt::Sched::NEVER;
+  }
+
+  // 送受信中: 半周期カウンタが0になるサイクルでエッジ
+  return ps2.sync_cycle + (ps2.half_period_cnt > 1 ? ps2.half_period_cnt : 1) - 1;
+}
+
+// ---------------------------------------------------------------
+//  Skip - 状態変化のない ticks サイクル分を一括処理
+// ---------------------------------------------------------------
+static void Skip(Fxt::System& sys, uint64_t ticks)
+{
+  State& ps2 = sys.ps2;
+  if (ticks == 0) return;
+
+  if (ps2.phase == Phase::IDLE)
+  {
+    if (HostClkLow(sys.via))
+    {
+      ps2.clk = true;
+      ps2.dat = true;
+      ps2.tx_delay_cnt = 400;
+    }
+    else if (ps2.q_head != ps2.q_tail)
+    {
+      ps2.tx_delay_cnt -= (int)ticks;
+    }
+    return;
+  }
+
+  ps2.half_period_cnt -= (int)ticks;
+}
+
+// ---------------------------------------------------------------
+//  Sync - upto 直前のサイクルまでを反映
+// ---------------------------------------------------------------
+void Sync(Fxt::System& sys, uint64_t upto)
+{
+  State& ps2 = sys.ps2;
+
+  while (ps2.sync_cycle < upto)
+  {
+    uint64_t next = NextStep(sys);
+    if (next >= upto)
+    {
+      Skip(sys, upto - ps2.sync_cycle);
+      ps2.sync_cycle = upto;
+      break;
+    }
+    Skip(sys, next - ps2.sync_cycle);
+    Step(sys);
+    ps2.sync_cycle = next + 1;
+  }
+}
+
+// ---------------------------------------------------------------
+//  Reschedule / OnEvent
+// ---------------------------------------------------------------
+void Reschedule(Fxt::System& sys)
+{
+  Fxt::Sched::Schedule(sys.sched, Fxt::Sched::EV_PS2, NextStep(sys));
+}
+
+void OnEvent(Fxt::System& sys, uint64_t cycle)
+{
+  Sync(sys, cycle + 1);
+  Reschedule(sys);
+}
+
 }
@@ -6,6 +6,9 @@
  *
  *
  * クロック周波数: HALF_PERIOD サイクルごとにCLK反転 (~12kHz at 8MHz CPU)
+ *
+ * 毎サイクル駆動はせず、状態が変化するサイクル (エッジ・送受信開始) だけを
+ * スケジューラのイベントとして登録する。その間のカウンタ減算は一括で反映する。
  */
 #pragma once
 #include <cstdint>
@@ -45,15 +48,23 @@ namespace Ps2
     // 現在のライン状態 (VIA Port B の入力として見える)
     bool clk = true;  // アイドル時はHIGH
     bool dat = true;  // アイドル時はHIGH
+
+    // ステートマシンが反映済みのサイクル (このサイクル以降は未適用)
+    uint64_t sync_cycle = 0;
   };
 
-  // CPUサイクルごとに呼ぶ
-  void Tick(Fxt::System& sys);
+  // upto 直前のサイクルまでのステートマシン動作を反映
+  // (ホスト側ライン = VIA ORB/DDRB を変更する前に呼ぶ)
+  void Sync(Fxt::System& sys, uint64_t upto);
+  // 次の状態変化サイクルをスケジューラに登録し直す
+  void Reschedule(Fxt::System& sys);
+  // 状態変化イベント (スケジューラから呼ばれる)
+  void OnEvent(Fxt::System& sys, uint64_t cycle);
 
   // キー押下→PS/2メイクコードをキューに積む
-  void KeyDown(State& ps2, int sapp_keycode);
+  void KeyDown(Fxt::System& sys, int sapp_keycode);
   // キー離し→PS/2ブレイクコード (F0 XX) をキューに積む
-  void KeyUp(State& ps2, int sapp_keycode);
+  void KeyUp(Fxt::System& sys, int sapp_keycode);
 
   // VIA Port Bリード用: CLK/DATビットを返す (その他のビットは0)
   uint8_t GetPortBBits(const State& ps2);
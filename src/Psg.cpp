@@ -6,6 +6,7 @@ namespace Psg
 
 void Init(State& psg, uint32_t sample_rate)
 {
+  Shutdown(psg); // 再初期化では作り直す
   psg.psg = PSG_new(CLOCK_HZ, sample_rate);
   PSG_reset(psg.psg);
   psg.addr_reg = 0;
@@ -0,0 +1,30 @@
+/* src/RomAot.hpp - ROM の事前変換コード (AOT)
+ *
+ * tools/rom_aot.py が assets/rom.bin をリセット・IRQ・NMI ベクタから辿って逆アセンブルし、
+ * 到達できる命令ごとに W65c02::Execute を並べた C++ を生成する (ビルド時に $(OBJ_DIR)/gen/RomAot.cpp)。
+ *   - オペランドと ROM データは生成コード内の定数表から読むので、コンパイル時に畳み込まれる
+ *   - 分岐・ジャンプ先が解析済みなら直接 goto、RTS/RTI などは PC で表引きする
+ *   - 解析できなかったアドレス・割り込み受付・停止条件ではインタプリタに戻る
+ *
+ * make ROM_AOT=1 (native コアの既定) でビルドに含まれる。読み込んだ ROM が生成元と
+ * 異なる場合と、EmulatorConfig::rom_aot (aot=0 引数) が false の場合は使わない。
+ * JIT 有効時は JIT が ROM も含めて変換するので、こちらは使わない。
+ */
+#pragma once
+#include <cstdint>
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace RomAot
+  {
+    // 生成元の ROM と sys.rom が一致するか
+    bool Matches(const System& sys);
+
+    // PC が解析済みの ROM 命令を指している間、命令を連続実行する
+    // (停止条件は W65c02::Run と同じ)。1命令も実行しなければ false
+    bool Run(System& sys, uint64_t target);
+  }
+}
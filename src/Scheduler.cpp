@@ -0,0 +1,125 @@
+/* src/Scheduler.cpp - 周辺機器イベントスケジューラ実装 */
+#include "Scheduler.hpp"
+#include "FxtSystem.hpp"
+#include "Via.hpp"
+#include "Ps2.hpp"
+#include "Prof.hpp"
+
+namespace Fxt
+{
+namespace Sched
+{
+  // ヒープ順序: 期限が早い方、同期限ならイベント番号が小さい方が先
+  static bool Before(const State& s, uint8_t a, uint8_t b)
+  {
+    if (s.due[a] != s.due[b]) return s.due[a] < s.due[b];
+    return a < b;
+  }
+
+  static void Swap(State& s, int i, int j)
+  {
+    uint8_t t = s.heap[i];
+    s.heap[i] = s.heap[j];
+    s.heap[j] = t;
+    s.pos[s.heap[i]] = (int8_t)i;
+    s.pos[s.heap[j]] = (int8_t)j;
+  }
+
+  static void SiftUp(State& s, int i)
+  {
+    while (i > 0)
+    {
+      int parent = (i - 1) / 2;
+      if (!Before(s, s.heap[i], s.heap[parent])) break;
+      Swap(s, i, parent);
+      i = parent;
+    }
+  }
+
+  static void SiftDown(State& s, int i)
+  {
+    for (;;)
+    {
+      int l = i * 2 + 1;
+      int r = l + 1;
+      int m = i;
+      if (l < s.heap_size && Before(s, s.heap[l], s.heap[m])) m = l;
+      if (r < s.heap_size && Before(s, s.heap[r], s.heap[m])) m = r;
+      if (m == i) break;
+      Swap(s, i, m);
+      i = m;
+    }
+  }
+
+  static void UpdateNextDue(State& s)
+  {
+    s.next_due = s.heap_size ? s.due[s.heap[0]] : NEVER;
+  }
+
+  // イベント登録 (登録済みなら期限を更新)
+  void Schedule(State& s, Event ev, uint64_t due)
+  {
+    if (due == NEVER) { Cancel(s, ev); return; }
+
+    int i = s.pos[ev];
+    if (i < 0)
+    {
+      i = s.heap_size++;
+      s.heap[i] = ev;
+      s.pos[ev] = (int8_t)i;
+      s.due[ev] = due;
+      SiftUp(s, i);
+    }
+    else
+    {
+      uint64_t old = s.due[ev];
+      s.due[ev] = due;
+      if (due < old) SiftUp(s, i);
+      else           SiftDown(s, i);
+    }
+    UpdateNextDue(s);
+  }
+
+  // イベント取り消し
+  void Cancel(State& s, Event ev)
+  {
+    int i = s.pos[ev];
+    if (i < 0) return;
+
+    s.pos[ev] = -1;
+    s.due[ev] = NEVER;
+    int last = --s.heap_size;
+    if (i != last)
+    {
+      s.heap[i] = s.heap[last];
+      s.pos[s.heap[i]] = (int8_t)i;
+      SiftDown(s, i);
+      SiftUp(s, i);
+    }
+    UpdateNextDue(s);
+  }
+
+  // 期限 <= now のイベントを全て処理
+  void Dispatch(System& sys)
+  {
+    State& s = sys.sched;
+    while (s.next_due <= s.now)
+    {
+      Event    ev    = (Event)s.heap[0];
+      uint64_t cycle = s.due[ev];
+      Cancel(s, ev); // ハンドラが必要なら再登録する
+
+      switch (ev)
+      {
+        case EV_VIA_T1: { FXT_PROF_ZONE(VIA); Via::OnTimer1(sys, cycle); } break;
+        case EV_VIA_T2: { FXT_PROF_ZONE(VIA); Via::OnTimer2(sys, cycle); } break;
+        case EV_PS2:    { FXT_PROF_ZONE(PS2); Ps2::OnEvent(sys, cycle);  } break;
+        case EV_VBLANK: { FXT_PROF_ZONE(VIA); OnVblank(sys, cycle);      } break;
+        case EV_AUDIO:  { FXT_PROF_ZONE(PSG); OnAudio(sys, cycle);       } break;
+        default: break;
+      }
+    }
+  }
+
+}
+}
@@ -0,0 +1,63 @@
+/* src/Scheduler.hpp - 周辺機器イベントスケジューラ
+ *
+ * 全体で共有する64bitサイクルクロックと、期限付きイベントの最小ヒープ。
+ * 周辺機器は「次に状態が変化するサイクル」をイベントとして登録し、
+ * 実行ループはクロックが期限に達したときだけ Dispatch を呼ぶ。
+ *
+ * サイクル番号の意味:
+ *   now = 実行中のCPUサイクル番号 (= 完了済みサイクル数)
+ *   期限 due のイベントは、サイクル due の CPU 動作の後に処理される
+ *   (旧実装の Tick 内で CPU → VIA → PS/2 → VBLANK の順に回していたのと同じ)
+ */
+#pragma once
+#include <cstdint>
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+
+  namespace Sched
+  {
+    // イベント種別 (同一サイクルではこの順に処理)
+    enum Event : uint8_t
+    {
+      EV_VIA_T1,  // VIA タイマ1 満了
+      EV_VIA_T2,  // VIA タイマ2 満了
+      EV_PS2,     // PS/2 クロック半周期エッジ / 状態遷移
+      EV_VBLANK,  // VBLANK (VIA CA2)
+      EV_AUDIO,   // 音声サンプリング
+      EV_COUNT
+    };
+
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    struct State
+    {
+      uint64_t now      = 0;     // 現在のCPUサイクル
+      uint64_t next_due = NEVER; // 最も近いイベントの期限 (ヒープ先頭のキャッシュ)
+
+      uint64_t due[EV_COUNT];    // イベントごとの期限
+      uint8_t  heap[EV_COUNT];   // 期限順の最小ヒープ (イベント番号)
+      int8_t   pos[EV_COUNT];    // ヒープ内の位置 (-1=未登録)
+      int      heap_size = 0;
+
+      State()
+      {
+        for (int i = 0; i < EV_COUNT; i++) { due[i] = NEVER; pos[i] = -1; }
+      }
+    };
+
+    // イベント登録 (登録済みなら期限を更新)
+    void Schedule(State& s, Event ev, uint64_t due);
+    // イベント取り消し
+    void Cancel(State& s, Event ev);
+    // 登録済みか
+    inline bool IsPending(const State& s, Event ev) { return s.pos[ev] >= 0; }
+
+    // 期限 <= now のイベントを全て処理
+    void Dispatch(System& sys);
+
+  }
+
+}
@@ -353,6 +353,7 @@ namespace Sd
               case 17:
                 sd.current_lba = arg;
                 LoadSector(sys);
+                sd.sectors_read++;
                 sd.response_buffer[0] = 0x00;
                 sd.resp_len = 1;
                 sd.phase = State::WAIT_RESPONSE;
@@ -480,6 +481,7 @@ namespace Sd
           sd.phase = State::WRITE_BUSY;
           sd.wait_cycles = 2;
           FlushSector(sys);
+          sd.sectors_written++;
         }
         return 0xFF;
       case State::WRITE_BUSY:
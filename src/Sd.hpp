@@ -61,6 +61,10 @@ namespace Fxt
 
       uint8_t sector_buffer[512];  // セクタデータ
       uint16_t data_idx = 0;
+
+      // 統計: 読み書きしたセクタ数 (性能モニタ用)
+      uint64_t sectors_read    = 0;
+      uint64_t sectors_written = 0;
     };
 
     // 操作関数
@@ -0,0 +1,195 @@
+/* src/Symbols.cpp - ゲストのシンボル表 */
+#include "Symbols.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace Fxt
+{
+namespace Symbols
+{
+  // これより離れたシンボルには結び付けない (ゼロページ変数などを誤って拾わないため)
+  static constexpr uint16_t MAX_OFFSET = 0x400;
+
+  // 拡張子が ext か (大文字小文字を区別しない)
+  static bool HasExt(const std::string& path, const char* ext)
+  {
+    size_t n = strlen(ext);
+    if (path.size() < n) return false;
+    for (size_t i = 0; i < n; i++)
+      if (tolower((unsigned char)path[path.size() - n + i]) != ext[i]) return false;
+    return true;
+  }
+
+  static void Add(std::vector<Symbol>& out, unsigned long addr, const std::string& name)
+  {
+    if (name.empty() || addr > 0xFFFF) return;
+    Symbol s;
+    s.addr = (uint16_t)addr;
+    s.name = name;
+    out.push_back(s);
+  }
+
+  // .dbg: sym id=0,name="reset",addrsize=absolute,scope=0,def=12,ref=3,val=0xF000,seg=1,type=lab
+  static void ParseDbg(FILE* fp, std::vector<Symbol>& out)
+  {
+    char line[1024];
+    while (fgets(line, sizeof(line), fp))
+    {
+      if (strncmp(line, "sym\t", 4) != 0) continue;
+      std::string name, type;
+      bool has_val = false;
+      unsigned long val = 0;
+      for (char* p = line + 4; *p && *p != '\n';)
+      {
+        char* eq = strchr(p, '=');
+        if (!eq) break;
+        std::string key(p, eq - p);
+        std::string value;
+        p = eq + 1;
+        if (*p == '"')
+        {
+          char* end = strchr(p + 1, '"');
+          if (!end) break;
+          value.assign(p + 1, end - p - 1);
+          p = end + 1;
+        }
+        else
+        {
+          char* end = p + strcspn(p, ",\n");
+          value.assign(p, end - p);
+          p = end;
+        }
+        if (*p == ',') p++;
+
+        if      (key == "name") name = value;
+        else if (key == "type") type = value;
+        else if (key == "val")  { val = strtoul(value.c_str(), nullptr, 0); has_val = true; }
+      }
+      if (has_val && type == "lab") Add(out, val, name);
+    }
+  }
+
+  // .map: "Exports list by name:" の後、"name  00F000 RLA" が1行に2組ずつ並ぶ
+  static void ParseMap(FILE* fp, std::vector<Symbol>& out)
+  {
+    char line[1024];
+    bool in_exports = false;
+    while (fgets(line, sizeof(line), fp))
+    {
+      if (!in_exports)
+      {
+        in_exports = strncmp(line, "Exports list by name:", 21) == 0;
+        continue;
+      }
+      if (line[0] == '-') continue; // 罫線
+      if (line[0] == '\n' || line[0] == '\r')
+      {
+        if (!out.empty()) break; // 節の終わり
+        continue;
+      }
+      std::istringstream ss(line);
+      std::string name, addr, flags;
+      while (ss >> name >> addr >> flags)
+        Add(out, strtoul(addr.c_str(), nullptr, 16), name);
+    }
+  }
+
+  // VICE: "al C:F000 .reset"
+  static void ParseVice(FILE* fp, std::vector<Symbol>& out)
+  {
+    char line[1024];
+    while (fgets(line, sizeof(line), fp))
+    {
+      std::istringstream ss(line);
+      std::string cmd, addr, name;
+      if (!(ss >> cmd >> addr >> name) || cmd != "al") continue;
+      size_t colon = addr.find(':');
+      if (colon != std::string::npos) addr = addr.substr(colon + 1);
+      if (name[0] == '.') name = name.substr(1);
+      Add(out, strtoul(addr.c_str(), nullptr, 16), name);
+    }
+  }
+
+  int Load(Table& table, const std::string& path, FILE* log)
+  {
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp)
+    {
+      if (log) fprintf(log, "[Symbols] %s を開けません\n", path.c_str());
+      return -1;
+    }
+    std::vector<Symbol> syms;
+    if      (HasExt(path, ".dbg")) ParseDbg(fp, syms);
+    else if (HasExt(path, ".map")) ParseMap(fp, syms);
+    else                           ParseVice(fp, syms);
+    fclose(fp);
+
+    // 既存の表と合わせてアドレス順に (同じアドレスは先に読んだものだけ残す)
+    size_t before = table.syms.size();
+    table.syms.insert(table.syms.end(), syms.begin(), syms.end());
+    std::stable_sort(table.syms.begin(), table.syms.end(),
+                     [](const Symbol& a, const Symbol& b) { return a.addr < b.addr; });
+    table.syms.erase(std::unique(table.syms.begin(), table.syms.end(),
+                                 [](const Symbol& a, const Symbol& b) { return a.addr == b.addr; }),
+                     table.syms.end());
+
+    if (log) fprintf(log, "[Symbols] %s: %u symbols\n", path.c_str(), (unsigned)(table.syms.size() - before));
+    return (int)syms.size();
+  }
+
+  bool LoadList(Table& table, const std::string& paths, FILE* log)
+  {
+    bool ok = true;
+    size_t start = 0;
+    while (start <= paths.size())
+    {
+      size_t end = paths.find(',', start);
+      if (end == std::string::npos) end = paths.size();
+      if (end > start && Load(table, paths.substr(start, end - start), log) < 0) ok = false;
+      start = end + 1;
+    }
+    return ok;
+  }
+
+  bool LoadForRom(Table& table, const std::string& rom_path, FILE* log)
+  {
+    size_t dot   = rom_path.find_last_of('.');
+    size_t slash = rom_path.find_last_of("/\\");
+    std::string stem = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+                       ? rom_path.substr(0, dot) : rom_path;
+    static const char* const EXTS[] = {".dbg", ".map", ".lbl"};
+    for (const char* ext : EXTS)
+    {
+      FILE* fp = fopen((stem + ext).c_str(), "r");
+      if (!fp) continue;
+      fclose(fp);
+      return Load(table, stem + ext, log) >= 0;
+    }
+    return false;
+  }
+
+  const Symbol* Find(const Table& table, uint16_t addr)
+  {
+    auto it = std::upper_bound(table.syms.begin(), table.syms.end(), addr,
+                               [](uint16_t a, const Symbol& s) { return a < s.addr; });
+    if (it == table.syms.begin()) return nullptr;
+    const Symbol& s = *(it - 1);
+    return addr - s.addr <= MAX_OFFSET ? &s : nullptr;
+  }
+
+  std::string Format(const Table& table, uint16_t addr)
+  {
+    const Symbol* s = Find(table, addr);
+    if (!s) return std::string();
+    if (s->addr == addr) return s->name;
+    char buf[16];
+    snprintf(buf, sizeof(buf), "+$%X", addr - s->addr);
+    return s->name + buf;
+  }
+
+} // namespace Symbols
+} // namespace Fxt
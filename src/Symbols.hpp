@@ -0,0 +1,46 @@
+/* src/Symbols.hpp - ゲストのシンボル表 (cc65 .dbg / .map / VICE ラベル)
+ *
+ * sd-monitor (ROM) と MIRACOS のモジュールは cl65 でビルドされるので、リンカの出力から
+ * アドレス → ラベル名の表を作り、プロファイラの出力やステータスバーで PC を「名前+オフセット」にする。
+ *   - .dbg : ld65 --dbgfile の出力。sym 行のうち type=lab のもの
+ *   - .map : ld65 -m の出力。"Exports list by name:" の節
+ *   - それ以外 : VICE ラベルファイル (ld65 -Ln の出力、"al C:F000 .reset" 形式)
+ * 複数のファイルを読み込める。同じアドレスに複数の名前があるときは先に読んだものを使う。
+ * 読み込んだ後は変更しないので、エミュレーションスレッドと描画スレッドから同時に引いてよい。
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Fxt
+{
+  namespace Symbols
+  {
+    struct Symbol
+    {
+      uint16_t    addr;
+      std::string name;
+    };
+
+    struct Table
+    {
+      std::vector<Symbol> syms; // アドレス順
+    };
+
+    // ファイルを読み込んで表に加える (形式は拡張子で判断)。読めた数を返し、開けなければ -1
+    int Load(Table& table, const std::string& path, FILE* log = stderr);
+    // "a.dbg,b.lbl" のようにカンマ区切りで複数読み込む。すべて開けたら true
+    bool LoadList(Table& table, const std::string& paths, FILE* log = stderr);
+
+    // ROM イメージと同じ名前の .dbg / .map / .lbl があれば最初に見つかったものを読み込む
+    bool LoadForRom(Table& table, const std::string& rom_path, FILE* log = stderr);
+
+    // addr 以下で最も近いシンボル (無いか、離れすぎていれば nullptr)
+    const Symbol* Find(const Table& table, uint16_t addr);
+
+    // "name" / "name+$1A"。シンボルが無ければ空文字列
+    std::string Format(const Table& table, uint16_t addr);
+  }
+}
@@ -0,0 +1,458 @@
+/* src/Trace.cpp - デコード済み命令のトレースキャッシュ実装 */
+#include "Trace.hpp"
+
+#if !FXT_CPU_VREMU
+
+#include "FxtSystem.hpp"
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+
+namespace Fxt
+{
+namespace Trace
+{
+  static constexpr int      MAX_INSNS   = 32;      // 1トレースの最大命令数
+  static constexpr size_t   MAX_TRACES  = 1 << 16; // これを超えたらキャッシュを捨てる
+  static constexpr size_t   MAX_RECORDS = 1 << 20; // 同上 (命令数の合計)
+  static constexpr int32_t  NO_TRACE    = -1;      // 先頭がデコード対象外
+
+  // 融合命令 (よく現れる2命令の並び): X(番号, 先頭オペコード, 後続オペコード, 表示名)
+#define FXT_TRACE_FUSIONS(X)                      \
+  X(0,  0xA9, 0x85, "LDA #     / STA zp")       \
+  X(1,  0xA9, 0x8D, "LDA #     / STA abs")      \
+  X(2,  0xA5, 0x85, "LDA zp    / STA zp")       \
+  X(3,  0xAD, 0x8D, "LDA abs   / STA abs")      \
+  X(4,  0xBD, 0x8D, "LDA abs,X / STA abs")      \
+  X(5,  0xB9, 0x8D, "LDA abs,Y / STA abs")      \
+  X(6,  0xB1, 0x8D, "LDA (zp),Y / STA abs")     \
+  X(7,  0xBD, 0x9D, "LDA abs,X / STA abs,X")    \
+  X(8,  0xB1, 0x91, "LDA (zp),Y / STA (zp),Y")  \
+  X(9,  0xE8, 0xD0, "INX / BNE")                \
+  X(10, 0xC8, 0xD0, "INY / BNE")                \
+  X(11, 0xCA, 0xD0, "DEX / BNE")                \
+  X(12, 0x88, 0xD0, "DEY / BNE")                \
+  X(13, 0x2C, 0x10, "BIT abs / BPL")            \
+  X(14, 0x2C, 0x30, "BIT abs / BMI")            \
+  X(15, 0x24, 0x10, "BIT zp / BPL")             \
+  X(16, 0x24, 0x30, "BIT zp / BMI")
+
+  struct Fusion
+  {
+    uint8_t     first, second;
+    const char* name;
+  };
+
+#define FXT_TRACE_FUSION_ENTRY(id, a, b, name) { a, b, name },
+  static const Fusion FUSIONS[] = { FXT_TRACE_FUSIONS(FXT_TRACE_FUSION_ENTRY) };
+#undef FXT_TRACE_FUSION_ENTRY
+  static constexpr int NUM_FUSIONS = sizeof(FUSIONS) / sizeof(FUSIONS[0]);
+
+  // 融合命令の統計
+  struct FusionStats
+  {
+    uint64_t sites = 0; // デコードした箇所数
+    uint64_t hits  = 0; // 2命令をまとめて実行した回数
+    uint64_t split = 0; // 1命令目の後で抜けた回数 (停止条件・割り込み・自己書き換え)
+  };
+
+  // 命令バイトをデコード時の保持値から返すバス (データの読み書きは Cpu::Bus のまま)
+  struct DecodedBus : Cpu::Bus
+  {
+    uint32_t bytes = 0; // 実行中の命令のバイト列
+    uint16_t pc    = 0; // そのアドレス
+
+    explicit DecodedBus(System& s) : Cpu::Bus{s} {}
+
+    uint8_t Fetch(uint16_t addr) { return (uint8_t)(bytes >> (((addr - pc) & 3) * 8)); }
+  };
+
+  // トレース (Cache::insns の連続区間)
+  struct Span
+  {
+    uint32_t first;      // 先頭の命令番号
+    uint32_t count;      // 命令数
+    uint32_t start, end; // 命令バイトの範囲 [start, end)
+    bool     valid;
+  };
+
+  struct Cache
+  {
+    std::vector<Insn>     insns;
+    std::vector<Span>     spans;
+    std::vector<int32_t>  entry;       // 先頭アドレス → spans 番号+1 (0 = 未デコード)
+    std::vector<uint32_t> pages[0x80]; // RAM ページ → そのページに掛かるトレース番号
+    uint32_t              gen = 0;     // 無効化のたびに進める (実行中のトレースを止める)
+    Handler               handlers[256];
+    FusionStats           fusion[NUM_FUSIONS];
+  };
+
+  // ---------------------------------------------------------------
+  //  ハンドラ表
+  // ---------------------------------------------------------------
+
+  template <int OPC>
+  static uint8_t Exec(W65c02::State& cpu, DecodedBus& bus)
+  {
+    return W65c02::Execute<DecodedBus, OPC>(cpu, bus);
+  }
+
+  template <int OPC>
+  struct Fill
+  {
+    static void To(Handler* table)
+    {
+      table[OPC] = Exec<OPC>;
+      Fill<OPC + 1>::To(table);
+    }
+  };
+  template <>
+  struct Fill<256>
+  {
+    static void To(Handler*) {}
+  };
+
+  // ---------------------------------------------------------------
+  //  デコード
+  // ---------------------------------------------------------------
+
+  // 命令長
+  static int Length(const W65c02::Opcode& o)
+  {
+    using namespace W65c02;
+    if (o.op == BBR || o.op == BBS) return 3;
+    switch (o.mode)
+    {
+      case IMP: case ACC: return 1;
+      case AB:  case ABX: case ABY: case AXP: case AYP: case IND: case INDX: return 3;
+      default: return 2;
+    }
+  }
+
+  // この命令でトレースを終える (PC を書き換える・割り込み状態を変える命令)
+  static bool EndsTrace(W65c02::Op op)
+  {
+    using namespace W65c02;
+    switch (op)
+    {
+      case BPL: case BMI: case BVC: case BVS: case BCC: case BCS: case BNE: case BEQ:
+      case BBR: case BBS: case BRA: case JMP: case JSR: case RTS: case RTI: case BRK:
+      case WAI: case STP:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // 命令を置ける領域の終端 (0 = 対象外)
+  static uint32_t RegionEnd(uint16_t pc)
+  {
+    if (pc < 0x8000)  return 0x8000;
+    if (pc >= 0xF000) return 0x10000;
+    return 0;
+  }
+
+  // 直前の命令と融合できる組の番号 (-1 = なし)
+  static int FindFusion(uint8_t first, uint8_t second)
+  {
+    for (int i = 0; i < NUM_FUSIONS; i++)
+      if (FUSIONS[i].first == first && FUSIONS[i].second == second) return i;
+    return -1;
+  }
+
+  // キャッシュを空にする
+  static void Flush(System& sys)
+  {
+    Cache& tc = *sys.trace;
+    std::fill(tc.entry.begin(), tc.entry.end(), 0);
+    tc.insns.clear();
+    tc.spans.clear();
+    for (int i = 0; i < 0x80; i++) tc.pages[i].clear();
+    memset(sys.trace_page, 0, sizeof(sys.trace_page));
+    tc.gen++;
+  }
+
+  // pc から始まるトレースをデコード (戻り値は entry に入れる値)
+  static int32_t Decode(System& sys, uint16_t pc)
+  {
+    Cache& tc = *sys.trace;
+    uint32_t region = RegionEnd(pc);
+    if (!region) return tc.entry[pc] = NO_TRACE;
+    if (tc.spans.size() >= MAX_TRACES || tc.insns.size() + MAX_INSNS > MAX_RECORDS) Flush(sys);
+
+    Cpu::Bus bus{sys};
+    Span s;
+    s.first = (uint32_t)tc.insns.size();
+    s.count = 0;
+    s.start = pc;
+    s.valid = true;
+
+    uint32_t addr = pc;
+    while (s.count < MAX_INSNS)
+    {
+      uint8_t opcode = bus.Read((uint16_t)addr);
+      const W65c02::Opcode& o = W65c02::OPCODES[opcode];
+      int len = Length(o);
+      if (addr + len > region) break;
+
+      // 直前の命令と融合できれば、直前の記録を融合命令の入口にする
+      if (s.count)
+      {
+        Insn& prev = tc.insns.back();
+        int   f    = FindFusion(prev.opcode, opcode);
+        if (f >= 0)
+        {
+          prev.slot = (uint16_t)(256 + f);
+          tc.fusion[f].sites++;
+        }
+      }
+
+      Insn in;
+      in.fn     = tc.handlers[opcode];
+      in.slot   = opcode;
+      in.bytes  = opcode;
+      for (int i = 1; i < len; i++) in.bytes |= (uint32_t)bus.Read((uint16_t)(addr + i)) << (i * 8);
+      in.pc     = (uint16_t)addr;
+      in.next   = (uint16_t)(addr + len);
+      in.opcode = opcode;
+      in.length = (uint8_t)len;
+      in.cycles = o.cycles;
+      tc.insns.push_back(in);
+      s.count++;
+      addr += len;
+      if (EndsTrace(o.op)) break;
+    }
+    if (!s.count) return tc.entry[pc] = NO_TRACE;
+    s.end = addr;
+
+    uint32_t id = (uint32_t)tc.spans.size();
+    tc.spans.push_back(s);
+    if (s.start < 0x8000)
+    {
+      for (uint32_t page = s.start >> 8; page <= (s.end - 1) >> 8; page++)
+      {
+        tc.pages[page].push_back(id);
+        sys.trace_page[page] = 1;
+      }
+    }
+    return tc.entry[pc] = (int32_t)id + 1;
+  }
+
+  // 有効なトレース (なければデコード)。デコードできなければ nullptr
+  static const Span* Find(System& sys, uint16_t pc)
+  {
+    Cache& tc = *sys.trace;
+    int32_t id = tc.entry[pc];
+    if (id == 0) id = Decode(sys, pc);
+    return id > 0 ? &tc.spans[id - 1] : nullptr;
+  }
+
+  // ---------------------------------------------------------------
+  //  公開API
+  // ---------------------------------------------------------------
+
+  void Init(System& sys)
+  {
+    if (!sys.trace)
+    {
+      sys.trace = new Cache;
+      sys.trace->entry.assign(0x10000, 0);
+      Fill<0>::To(sys.trace->handlers);
+    }
+    Flush(sys);
+  }
+
+  void Shutdown(System& sys)
+  {
+    delete sys.trace;
+    sys.trace = nullptr;
+    memset(sys.trace_page, 0, sizeof(sys.trace_page));
+  }
+
+  void OnWrite(System& sys, uint16_t addr)
+  {
+    Cache& tc = *sys.trace;
+    std::vector<uint32_t>& ids = tc.pages[addr >> 8];
+
+    // 書き込み先を含むトレースを無効化 (ページ内の他のトレースは残す)
+    size_t keep = 0;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      Span& s = tc.spans[ids[i]];
+      if (s.valid && addr >= s.start && addr < s.end)
+      {
+        s.valid = false;
+        tc.entry[s.start] = 0;
+        tc.gen++;
+      }
+      if (s.valid) ids[keep++] = ids[i];
+    }
+    ids.resize(keep);
+    if (ids.empty()) sys.trace_page[addr >> 8] = 0;
+  }
+
+  const Insn* Get(System& sys, uint16_t pc, int& count)
+  {
+    count = 0;
+    if (!sys.trace) return nullptr;
+    const Span* s = Find(sys, pc);
+    if (!s) return nullptr;
+    count = (int)s->count;
+    return &sys.trace->insns[s->first];
+  }
+
+  void DumpStats(const System& sys, FILE* fp)
+  {
+    if (!sys.trace) return;
+    const Cache& tc = *sys.trace;
+    uint64_t hits = 0, split = 0;
+    fprintf(fp, "[Trace]   %-24s %8s %12s %12s %6s\n", "fused instructions", "sites", "hits", "split", "hit%");
+    for (int i = 0; i < NUM_FUSIONS; i++)
+    {
+      const FusionStats& f = tc.fusion[i];
+      uint64_t runs = f.hits + f.split;
+      fprintf(fp, "[Trace]   %-24s %8" PRIu64 " %12" PRIu64 " %12" PRIu64 " %6.1f\n",
+              FUSIONS[i].name, f.sites, f.hits, f.split, runs ? 100.0 * f.hits / runs : 0.0);
+      hits  += f.hits;
+      split += f.split;
+    }
+    fprintf(fp, "[Trace]   %-24s %8s %12" PRIu64 " %12" PRIu64 " %6.1f\n", "total", "",
+            hits, split, hits + split ? 100.0 * hits / (hits + split) : 0.0);
+  }
+
+  // 命令を連続実行する
+  // FXT_W65C02_THREADED=1 では W65c02::Run と同様にハンドラ末尾から次の記録のハンドラへ直接ジャンプする
+  // (融合命令もここで実行する。switch 版は記録を1命令ずつ実行する)
+  void Run(System& sys, uint64_t target)
+  {
+    Cache&          tc       = *sys.trace;
+    W65c02::State&  cpu      = sys.cpu;
+    uint64_t&       now      = sys.sched.now;
+    const uint64_t& next_due = sys.sched.next_due;
+    Cpu::Bus        bus{sys};
+    DecodedBus      dbus(sys);
+    W65c02::IdleLoop loop;
+
+    // トレースに入れる状態か (I フラグでマスクされた IRQ はトレースを止めない)
+#define FXT_TRACE_ENTERABLE() \
+    (!(cpu.step | cpu.stp | cpu.wai | cpu.nmi) && !(cpu.irq && !(cpu.p & W65c02::FLAG_I)))
+    // 記録した命令を実行中の命令として設定
+#define FXT_TRACE_LOAD(in)          \
+    cpu.opcode_addr = (in)->pc;     \
+    cpu.opcode      = (in)->opcode; \
+    cpu.pc          = (in)->pc + 1; \
+    dbus.pc         = (in)->pc;     \
+    dbus.bytes      = (in)->bytes;
+
+#if FXT_W65C02_THREADED
+#define FXT_TRACE_ROW(X, h) \
+  X(h##0) X(h##1) X(h##2) X(h##3) X(h##4) X(h##5) X(h##6) X(h##7) \
+  X(h##8) X(h##9) X(h##A) X(h##B) X(h##C) X(h##D) X(h##E) X(h##F)
+#define FXT_TRACE_ALL(X) \
+  FXT_TRACE_ROW(X, 0x0) FXT_TRACE_ROW(X, 0x1) FXT_TRACE_ROW(X, 0x2) FXT_TRACE_ROW(X, 0x3) \
+  FXT_TRACE_ROW(X, 0x4) FXT_TRACE_ROW(X, 0x5) FXT_TRACE_ROW(X, 0x6) FXT_TRACE_ROW(X, 0x7) \
+  FXT_TRACE_ROW(X, 0x8) FXT_TRACE_ROW(X, 0x9) FXT_TRACE_ROW(X, 0xA) FXT_TRACE_ROW(X, 0xB) \
+  FXT_TRACE_ROW(X, 0xC) FXT_TRACE_ROW(X, 0xD) FXT_TRACE_ROW(X, 0xE) FXT_TRACE_ROW(X, 0xF)
+#define FXT_TRACE_LABEL(n) &&op_##n,
+#define FXT_TRACE_FUSED_LABEL(id, a, b, name) &&fu_##id,
+    static void* const HANDLERS[256 + NUM_FUSIONS] = {
+      FXT_TRACE_ALL(FXT_TRACE_LABEL) FXT_TRACE_FUSIONS(FXT_TRACE_FUSED_LABEL)
+    };
+#undef FXT_TRACE_FUSED_LABEL
+#undef FXT_TRACE_LABEL
+
+    const Insn* in  = nullptr;
+    const Insn* end = nullptr;
+    uint32_t    gen = 0;
+
+  enter:
+    if (FXT_TRACE_ENTERABLE())
+    {
+      const Span* span = Find(sys, cpu.pc);
+      if (span)
+      {
+        in  = &tc.insns[span->first];
+        end = in + span->count;
+        gen = tc.gen;
+        FXT_TRACE_LOAD(in)
+        goto *HANDLERS[in->slot];
+      }
+    }
+    loop = W65c02::IdleLoop();
+    if (!W65c02::SkipWait(cpu, now, target, next_due)) now += W65c02::InstCycle(cpu, bus);
+    if (cpu.stp || now >= target || now > next_due) return;
+    goto enter;
+
+    // 次の記録へ (停止条件・割り込み・自己書き換え・トレース末尾で enter に戻る)
+#define FXT_TRACE_NEXT()                                                     \
+    if (now >= target || now > next_due || cpu.stp) return;                  \
+    if (++in == end || !FXT_TRACE_ENTERABLE() || tc.gen != gen) goto enter;  \
+    FXT_TRACE_LOAD(in)                                                       \
+    goto *HANDLERS[in->slot];
+
+#define FXT_TRACE_HANDLER(n)                                                 \
+  op_##n:                                                                    \
+    now += W65c02::Execute<DecodedBus, n>(cpu, dbus);                        \
+    if (W65c02::IsLoopBranch(n))                                             \
+      W65c02::OnLoopBranch(loop, cpu, dbus, now, target, next_due);          \
+    FXT_TRACE_NEXT()
+    FXT_TRACE_ALL(FXT_TRACE_HANDLER)
+
+    // 融合命令: 1命令目の後で抜ける条件がなければ、ディスパッチせずに2命令目を実行
+#define FXT_TRACE_FUSED_HANDLER(id, a, b, name)                              \
+  fu_##id:                                                                   \
+    now += W65c02::Execute<DecodedBus, a>(cpu, dbus);                        \
+    if (now >= target || now > next_due || !FXT_TRACE_ENTERABLE() || tc.gen != gen) \
+    {                                                                        \
+      tc.fusion[id].split++;                                                 \
+      FXT_TRACE_NEXT()                                                       \
+    }                                                                        \
+    ++in;                                                                    \
+    FXT_TRACE_LOAD(in)                                                       \
+    now += W65c02::Execute<DecodedBus, b>(cpu, dbus);                        \
+    tc.fusion[id].hits++;                                                    \
+    if (W65c02::IsLoopBranch(b))                                             \
+      W65c02::OnLoopBranch(loop, cpu, dbus, now, target, next_due);          \
+    FXT_TRACE_NEXT()
+    FXT_TRACE_FUSIONS(FXT_TRACE_FUSED_HANDLER)
+#undef FXT_TRACE_FUSED_HANDLER
+#undef FXT_TRACE_HANDLER
+#undef FXT_TRACE_NEXT
+#undef FXT_TRACE_ALL
+#undef FXT_TRACE_ROW
+#else
+    do
+    {
+      const Span* span = FXT_TRACE_ENTERABLE() ? Find(sys, cpu.pc) : nullptr;
+      if (!span)
+      {
+        loop = W65c02::IdleLoop();
+        if (!W65c02::SkipWait(cpu, now, target, next_due)) now += W65c02::InstCycle(cpu, bus);
+        continue;
+      }
+      uint32_t gen = tc.gen;
+      for (const Insn* in = &tc.insns[span->first], *end = in + span->count; in != end; ++in)
+      {
+        FXT_TRACE_LOAD(in)
+        now += in->fn(cpu, dbus);
+        if (W65c02::IsLoopBranch(in->opcode))
+          W65c02::OnLoopBranch(loop, cpu, dbus, now, target, next_due);
+        if (now >= target || now > next_due) return;
+        if (!FXT_TRACE_ENTERABLE() || tc.gen != gen) break;
+      }
+    }
+    while (!cpu.stp && now < target && now <= next_due);
+#endif
+#undef FXT_TRACE_LOAD
+#undef FXT_TRACE_ENTERABLE
+  }
+
+#undef FXT_TRACE_FUSIONS
+
+}
+}
+
+#endif
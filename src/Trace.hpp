@@ -0,0 +1,68 @@
+/* src/Trace.hpp - デコード済み命令のトレースキャッシュ
+ *
+ * PC から始まる直線的な命令列を一度だけデコードし、命令ごとに
+ * ハンドラ (W65c02::Execute の実体)・命令バイト・基本サイクル数・次の PC を記録しておく。
+ * 2回目以降はオペコードのフェッチと表引きを省いてハンドラを順に呼ぶ。
+ *   - トレースは分岐・ジャンプ・サブルーチン・割り込み系命令 (WAI/STP 含む) の直後で終わる
+ *   - RAM ($0000-$7FFF) と ROM ($F000-$FFFF) の命令だけを対象とし、領域を跨がない
+ *   - RAM への書き込みで、そのページに掛かるトレースのうち書き込み先を含むものを無効化する
+ *   - 割り込み受付・WAI・STP・Tick 途中の状態はインタプリタ (W65c02::InstCycle) で処理する
+ *
+ * threaded dispatch では、よく現れる2命令の並び (LDA/STA、INX+BNE、BIT+BPL など) を
+ * デコード時に融合命令として記録し、間の分岐を省いて続けて実行する。
+ * 1命令目の後で停止条件・割り込み・自己書き換えに当たったときは、そこで通常の命令単位に戻る。
+ *
+ * native コアでのみ使え、実行時は EmulatorConfig::trace (trace=1 引数) で切り替える。
+ * JIT 有効時は JIT を優先する。Get はプロファイラなどデコード済みの命令列を見たい処理からも使える。
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+namespace Fxt
+{
+  // 前方宣言
+  struct System;
+  namespace W65c02 { struct State; }
+
+  namespace Trace
+  {
+    // キャッシュ本体・命令バイトを保持値から返すバス (Trace.cpp 内で定義)
+    struct Cache;
+    struct DecodedBus;
+
+    // 1命令を実行して消費サイクル数を返す
+    typedef uint8_t (*Handler)(W65c02::State& cpu, DecodedBus& bus);
+
+    // デコード済み命令
+    struct Insn
+    {
+      Handler  fn;
+      uint32_t bytes;  // 命令バイト (下位からオペコード・オペランド)
+      uint16_t pc;     // 命令のアドレス
+      uint16_t next;   // 次の命令のアドレス (分岐しない場合)
+      uint8_t  opcode;
+      uint8_t  length; // 命令長 [バイト]
+      uint8_t  cycles; // 基本サイクル数
+      uint16_t slot;   // 実行するハンドラ (0-255 = オペコード、256- = 次の命令との融合命令)
+    };
+
+    // 初期化 (キャッシュを空にする)
+    void Init(System& sys);
+    // 解放
+    void Shutdown(System& sys);
+
+    // 命令を連続実行する (W65c02::Run と同じ停止条件)
+    void Run(System& sys, uint64_t target);
+
+    // トレースの掛かった RAM ページへ書き込まれた (sys.trace_page[addr >> 8] != 0 のときに呼ぶ)
+    void OnWrite(System& sys, uint16_t addr);
+
+    // 融合命令の統計 (箇所数・まとめて実行した回数・途中で抜けた回数) を出力
+    void DumpStats(const System& sys, FILE* fp);
+
+    // pc から始まるトレース (未デコードならデコードする)。
+    // 命令数を count に返す。デコードできなければ nullptr
+    const Insn* Get(System& sys, uint16_t pc, int& count);
+  }
+}
@@ -9,7 +9,11 @@
 
 #include "Ui.hpp"
 #include "Sd.hpp"
-#include "lib/vrEmu6502.h"
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 extern "C" const char* platform_get_ui_font_path(void);
 
@@ -82,10 +86,232 @@ void NewFrame(int w, int h, double delta_time, float dpi)
   simgui_new_frame(&fd);
 }
 
+// ------------------------------------------------------------------
+//  GetStatus  System からステータスバーの表示内容を作る
+// ------------------------------------------------------------------
+Status GetStatus(const System& sys)
+{
+  Status st;
+  st.regs       = Cpu::GetRegs(sys);
+  st.sd_mounted = sys.sd.image_fp != nullptr;
+  st.cycles     = sys.sched.now;
+  st.symbols    = &sys.symbols;
+  st.sd_sectors = sys.sd.sectors_read + sys.sd.sectors_written;
+  st.target_hz  = (double)sys.cfg.cpu_hz * sys.cfg.sim_speed;
+  return st;
+}
+
+// ------------------------------------------------------------------
+//  性能モニタ  毎フレームの計測値を履歴に積み、直近 N 秒のグラフと p50 / p99 を出す
+//  (平均では見えない一瞬の引っかかりを見るため、ウィンドウを閉じていても積み続ける)
+// ------------------------------------------------------------------
+typedef std::chrono::steady_clock PerfClock;
+
+enum PerfMetric
+{
+  PM_FRAME,   // ホストのフレーム時間 (frame_cb の間隔)
+  PM_EMU,     // エミュレーション
+  PM_RENDER,  // Chdz::RenderFrame
+  PM_TEXTURE, // テクスチャ転送
+  PM_AUDIO,   // 再生待ちの音声
+  PM_SD,      // SD セクタ / 秒
+  PM_MHZ,     // エミュレーション速度
+  PM_COUNT
+};
+
+struct PerfInfo
+{
+  const char* ja;
+  const char* en;
+  const char* unit;
+};
+
+static const PerfInfo PERF_INFO[PM_COUNT] = {
+  {"フレーム時間",     "Frame time",     "ms"},
+  {"エミュレーション", "Emulation",      "ms"},
+  {"RenderFrame",      "RenderFrame",    "ms"},
+  {"テクスチャ転送",   "Texture upload", "ms"},
+  {"音声バッファ",     "Audio buffer",   "ms"},
+  {"SD",               "SD",             "sect/s"},
+  {"速度",             "Speed",          "MHz"},
+};
+
+static constexpr int    PERF_MAX_SEC   = 60;   // 集計期間の上限 [s]
+static constexpr int    PERF_MAX_HZ    = 240;  // 想定する表示リフレッシュレートの上限 (frame_cb ごとに1サンプル)
+static constexpr int    PERF_HISTORY   = PERF_MAX_SEC * PERF_MAX_HZ;
+static constexpr double PERF_STALL_SEC = 0.1;  // これだけサイクルが進まなければ速度 0 とみなす
+
+struct PerfHistory
+{
+  double t[PERF_HISTORY];         // 記録時刻 [s] (起動から)
+  float v[PM_COUNT][PERF_HISTORY];
+  int   head  = 0;
+  int   count = 0;
+
+  bool                  started = false;
+  PerfClock::time_point t0, last;
+  PerfClock::time_point cycles_at;      // cycles が最後に進んだ時刻
+  uint64_t              cycles  = 0;
+  uint64_t              sectors = 0;
+  float                 mhz     = 0.0f; // 直近の速度 (サイクルが進んだ区間で求める)
+  float                 sps     = 0.0f;
+};
+static PerfHistory s_perf;
+
+static void RecordPerf(const Status& st)
+{
+  PerfHistory&          h   = s_perf;
+  PerfClock::time_point now = PerfClock::now();
+  if (!h.started)
+  {
+    h.started   = true;
+    h.t0        = h.last = h.cycles_at = now;
+    h.cycles    = st.cycles;
+    h.sectors   = st.sd_sectors;
+    return;
+  }
+  double dt = std::chrono::duration<double>(now - h.last).count();
+  h.last = now;
+
+  // 速度・SD はサイクルが進んだときにその区間で求める
+  // (エミュレーションスレッドのスライスと描画フレームがずれても 0 と倍を行き来しないように)
+  if (st.cycles != h.cycles)
+  {
+    double span = std::chrono::duration<double>(now - h.cycles_at).count();
+    if (st.cycles > h.cycles && span > 0)
+    {
+      h.mhz = (float)((st.cycles - h.cycles) / span * 1e-6);
+      h.sps = st.sd_sectors >= h.sectors ? (float)((st.sd_sectors - h.sectors) / span) : 0.0f;
+    }
+    h.cycles    = st.cycles;
+    h.sectors   = st.sd_sectors;
+    h.cycles_at = now;
+  }
+  else if (std::chrono::duration<double>(now - h.cycles_at).count() > PERF_STALL_SEC)
+  {
+    h.mhz = 0.0f;
+    h.sps = 0.0f;
+  }
+
+  int i = h.head;
+  h.t[i]             = std::chrono::duration<double>(now - h.t0).count();
+  h.v[PM_FRAME][i]   = (float)(dt * 1000.0);
+  h.v[PM_EMU][i]     = st.emu_ms;
+  h.v[PM_RENDER][i]  = st.render_ms;
+  h.v[PM_TEXTURE][i] = st.texture_ms;
+  h.v[PM_AUDIO][i]   = st.audio_ms;
+  h.v[PM_SD][i]      = h.sps;
+  h.v[PM_MHZ][i]     = h.mhz;
+  h.head = (h.head + 1) % PERF_HISTORY;
+  if (h.count < PERF_HISTORY) h.count++;
+}
+
+// PlotLines 用: 履歴の start 番目から
+struct PerfPlot
+{
+  const float* v;
+  int          start;
+};
+
+static float PerfValue(void* data, int idx)
+{
+  const PerfPlot& p = *static_cast<const PerfPlot*>(data);
+  return p.v[(p.start + idx) % PERF_HISTORY];
+}
+
+// 昇順に並べた値の p パーセンタイル
+static float Percentile(const std::vector<float>& sorted, double p)
+{
+  size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+  return sorted[i];
+}
+
+static void PerfWindow(State& ui, const Status& status)
+{
+  if (!ui.show_perf) return;
+
+  ImGui::SetNextWindowSize(ImVec2(460 * s_dpi, 0), ImGuiCond_FirstUseEver);
+  if (ImGui::Begin(L("性能モニタ", "Performance"), &ui.show_perf))
+  {
+    ImGui::SliderInt(L("集計期間 [秒]", "Window [s]"), &ui.perf_seconds, 1, PERF_MAX_SEC);
+
+    // 集計期間に入るサンプル (新しい方から数える)
+    const PerfHistory& h = s_perf;
+    int n = 0;
+    if (h.count)
+    {
+      double newest = h.t[(h.head + PERF_HISTORY - 1) % PERF_HISTORY];
+      while (n < h.count && newest - h.t[(h.head + PERF_HISTORY - 1 - n) % PERF_HISTORY] <= ui.perf_seconds)
+        n++;
+    }
+    int start = (h.head + PERF_HISTORY - n) % PERF_HISTORY;
+
+    // PERF_MAX_HZ を超えるリフレッシュレートでは履歴が集計期間に届かないので、実際の期間を示す
+    if (n == PERF_HISTORY)
+    {
+      double span = h.t[(h.head + PERF_HISTORY - 1) % PERF_HISTORY] - h.t[start];
+      if (span < ui.perf_seconds - 0.5)
+        ImGui::TextDisabled(L("履歴は直近 %.1f 秒分", "History covers the last %.1f s"), span);
+    }
+
+    static std::vector<float> s_sorted;
+    for (int m = 0; m < PM_COUNT; m++)
+    {
+      const PerfInfo& info = PERF_INFO[m];
+      s_sorted.clear();
+      for (int i = 0; i < n; i++)
+      {
+        float v = h.v[m][(start + i) % PERF_HISTORY];
+        if (v >= 0) s_sorted.push_back(v);
+      }
+      ImGui::PushID(m);
+      ImGui::Separator();
+      if (s_sorted.empty())
+      {
+        ImGui::TextDisabled("%s: -", L(info.ja, info.en));
+        ImGui::PopID();
+        continue;
+      }
+      float cur = h.v[m][(h.head + PERF_HISTORY - 1) % PERF_HISTORY];
+      std::sort(s_sorted.begin(), s_sorted.end());
+      float p50 = Percentile(s_sorted, 0.50);
+      float p99 = Percentile(s_sorted, 0.99);
+      float max = s_sorted.back();
+
+      ImGui::Text("%s", L(info.ja, info.en));
+      ImGui::SameLine(140 * s_dpi);
+      ImGui::PushFont(s_mono_font);
+      ImGui::Text("%8.2f %-6s p50 %8.2f  p99 %8.2f  max %8.2f", cur, info.unit, p50, p99, max);
+      ImGui::PopFont();
+
+      // 目安の線の代わりに目標値を重ねて表示し、縦軸に含める
+      float scale_max = max;
+      char overlay[48] = "";
+      if (m == PM_MHZ && status.target_hz > 0)
+      {
+        float target = (float)(status.target_hz * 1e-6);
+        snprintf(overlay, sizeof(overlay), "%s %.2f MHz", L("目標", "target"), target);
+        scale_max = std::max(scale_max, target * 1.1f);
+      }
+      else if (m == PM_FRAME || m == PM_EMU)
+      {
+        float budget = 1000.0f / EmulatorConfig::HOST_FPS;
+        snprintf(overlay, sizeof(overlay), "%s %.1f ms", L("1フレーム", "frame"), budget);
+        scale_max = std::max(scale_max, budget * 1.1f);
+      }
+      PerfPlot plot = {h.v[m], start};
+      ImGui::PlotLines("##plot", PerfValue, &plot, n, 0, overlay[0] ? overlay : nullptr,
+                       0.0f, scale_max > 0 ? scale_max : 1.0f, ImVec2(-1, 40 * s_dpi));
+      ImGui::PopID();
+    }
+  }
+  ImGui::End();
+}
+
 // ------------------------------------------------------------------
 //  Render  ImGui ウィジェット構築 + simgui_render
 // ------------------------------------------------------------------
-void Render(State& ui, const System& sys, float win_w, float win_h)
+void Render(State& ui, const Status& status, float win_w, float win_h)
 {
   // 実効言語: フォントが利用可能な場合のみ日本語を使う
   s_use_japanese = s_has_japanese_font && ui.lang_japanese;
@@ -111,6 +337,14 @@ void Render(State& ui, const System& sys, float win_w, float win_h)
       ImGui::EndMenu();
     }
 
+    if (ImGui::BeginMenu(L("ツール", "Tools")))
+    {
+      if (ImGui::MenuItem(L("ホットスポット計測", "Hotspot Profiling"), nullptr, ui.hotspot_active))
+        ui.request_hotspot = true;
+      ImGui::MenuItem(L("性能モニタ", "Performance Monitor"), nullptr, &ui.show_perf);
+      ImGui::EndMenu();
+    }
+
     // ---- 言語メニュー ----
     if (ImGui::BeginMenu(L("言語", "Language")))
     {
@@ -152,20 +386,23 @@ void Render(State& ui, const System& sys, float win_w, float win_h)
       ImGui::PushFont(s_mono_font); // 等幅フォントに切り替え
 
       // ---- CPU レジスタ ----
-      uint16_t pc   = vrEmu6502GetPC(sys.cpu);
-      uint8_t  sp   = vrEmu6502GetStackPointer(sys.cpu);
-      uint8_t  sr   = vrEmu6502GetStatus(sys.cpu);
-      uint8_t  acc  = vrEmu6502GetAcc(sys.cpu);
-      uint8_t  x    = vrEmu6502GetX(sys.cpu);
-      uint8_t  y    = vrEmu6502GetY(sys.cpu);
+      const Cpu::Regs& r = status.regs;
 
       ImGui::Text("PC:%04X SP:%02X P:%02X A:%02X X:%02X Y:%02X",
-                  pc, sp, sr, acc, x, y);
+                  r.pc, r.sp, r.p, r.a, r.x, r.y);
+
+      // PC のシンボル (読み込まれていれば)
+      if (status.symbols && !status.symbols->syms.empty())
+      {
+        std::string name = Symbols::Format(*status.symbols, r.pc);
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", name.empty() ? "-" : name.c_str());
+      }
 
       ImGui::SameLine(0, 20);
 
       // ---- SD カード状態 ----
-      if (sys.sd.image_fp != nullptr)
+      if (status.sd_mounted)
         ImGui::TextColored(ImVec4(0.2f, 1.0f, 0.2f, 1.0f), "SD:OK");
       else
         ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "SD:--");
@@ -177,20 +414,20 @@ void Render(State& ui, const System& sys, float win_w, float win_h)
       static float  s_disp_mhz = 0.0f;
       static float  s_disp_fps = 0.0f;
       static int    s_frame_cnt = 0;
-      static int    s_tick_acc  = 0;
+      static uint64_t s_cycles0 = status.cycles; // 計測区間の開始サイクル
 
       double dt = sapp_frame_duration();
       s_accum    += dt;
       s_frame_cnt++;
-      s_tick_acc += sys.cfg.ticks_per_frame();
 
+      if (status.cycles < s_cycles0) s_cycles0 = status.cycles; // ハードリセット
       if (s_accum >= 0.5)
       {
         s_disp_fps = (float)(s_frame_cnt / s_accum);
-        s_disp_mhz = (float)(s_tick_acc  / s_accum) * 1e-6f;
+        s_disp_mhz = (float)((status.cycles - s_cycles0) / s_accum) * 1e-6f;
         s_accum    = 0.0;
         s_frame_cnt = 0;
-        s_tick_acc  = 0;
+        s_cycles0   = status.cycles;
       }
 
       ImGui::Text("%.2f MHz  %.1f FPS", s_disp_mhz, s_disp_fps);
@@ -201,6 +438,10 @@ void Render(State& ui, const System& sys, float win_w, float win_h)
     ImGui::PopStyleVar(2);
   }
 
+  // ---- 性能モニタ ----
+  RecordPerf(status);
+  PerfWindow(ui, status);
+
   // ---- GPU レンダリング ----
   simgui_render();
 }
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "FxtSystem.hpp"
+#include "Cpu.hpp"
 
 namespace Fxt
 {
@@ -14,14 +15,38 @@ namespace Ui
     bool request_hard_reset = false;
     bool request_vhd_load   = false;
     bool request_vhd_dl     = false;  // Web 専用
+    bool request_hotspot    = false;  // ホットスポット計測の開始・終了 (終了時に書き出す)
+    bool hotspot_active     = false;  // 計測中 (メニューのチェック表示)
+    bool show_perf          = false;  // 性能モニタのウィンドウ
+    int  perf_seconds       = 10;     // 性能モニタの p50 / p99 の集計期間 [s]
     float menu_h   = 20.0f;  // メニューバー実高さ（次フレームでレイアウトに反映）
     float status_h = 20.0f;  // ステータスバー実高さ
     bool  lang_japanese = true;  // true=日本語 / false=English
   };
 
+  // ステータスバーに出す状態 (エミュレーションスレッドから受け取った値でもよい)
+  struct Status
+  {
+    Cpu::Regs regs;
+    bool      sd_mounted;
+    uint64_t  cycles;  // 実行済みサイクル数 (MHz 表示用)
+    const Symbols::Table* symbols; // PC の横に出すシンボル (読み込み後は変更されない)
+
+    // 性能モニタ用 (測っていない項目は負)
+    float    emu_ms     = -1; // 直近のスライスの実行時間 (RunCycles)
+    float    render_ms  = -1; // 直近の Chdz::RenderFrame
+    float    texture_ms = -1; // このフレームのテクスチャ転送
+    float    audio_ms   = -1; // 再生待ちの音声
+    uint64_t sd_sectors = 0;  // SD カードの読み書きセクタ数 (累計)
+    double   target_hz  = 0;  // 目標のエミュレーション速度 (cpu_hz × sim_speed)
+  };
+
+  // System から Status を作る
+  Status GetStatus(const System& sys);
+
   void Init(int w, int h, float dpi);
   void NewFrame(int w, int h, double delta_time, float dpi);
-  void Render(State& ui, const System& sys, float win_w, float win_h);
+  void Render(State& ui, const Status& status, float win_w, float win_h);
   void Shutdown();
 
 } // namespace Ui
@@ -8,19 +8,103 @@ namespace Fxt
 {
 namespace Via
 {
+  // タイマ1の現在カウンタ値 (サイクル cycle の CPU 動作時点で見える値)
+  // ロード後 t1_load サイクルでカウンタ0を見て満了し、以降は
+  // フリーランならラッチ値から、ワンショットなら0xFFFFからロールオーバーして回り続ける
+  static uint16_t T1Counter(const State& via, uint64_t cycle)
+  {
+    if (!via.t1_running) return via.t1_load;
+
+    uint64_t elapsed = cycle - via.t1_load_cycle;
+    if (elapsed <= via.t1_load) return (uint16_t)(via.t1_load - elapsed);
+    elapsed -= (uint64_t)via.t1_load + 1; // 満了後の経過サイクル
+
+    if (via.reg_acr & 0x40) // ACR bit6: フリーラン (周期 = ラッチ値+1)
+    {
+      uint32_t latch = (via.t1_latch_h << 8) | via.t1_latch_l;
+      return (uint16_t)(latch - elapsed % (latch + 1));
+    }
+    return (uint16_t)(0xFFFF - elapsed % 0x10000);
+  }
+
+  // タイマ2の現在カウンタ値 (ワンショットのみ)
+  static uint16_t T2Counter(const State& via, uint64_t cycle)
+  {
+    // ACR bit5 = パルスカウントモード: 停止
+    if (!via.t2_running || (via.reg_acr & 0x20)) return via.t2_load;
+
+    uint64_t elapsed = cycle - via.t2_load_cycle;
+    if (elapsed <= via.t2_load) return (uint16_t)(via.t2_load - elapsed);
+    elapsed -= (uint64_t)via.t2_load + 1;
+    return (uint16_t)(0xFFFF - elapsed % 0x10000);
+  }
+
+  // 現在値を起点にタイマを置き直す
+  // (カウンタの進み方を変えるACR・ラッチ書き込みの前に呼ぶ)
+  static void Rebase(System& sys)
+  {
+    State& via = sys.via;
+    uint64_t now = sys.sched.now;
+    via.t1_load = T1Counter(via, now);
+    via.t2_load = T2Counter(via, now);
+    via.t1_load_cycle = now;
+    via.t2_load_cycle = now;
+  }
+
+  // 次のタイマ満了をスケジューラに登録
+  // カウンタ0を見るサイクル = 基準サイクル + その時点のカウンタ値
+  static void ScheduleT1(System& sys, uint64_t now)
+  {
+    State& via = sys.via;
+    // フリーランなら毎周期、ワンショットなら未発火の間だけ割り込みが起きる
+    if (via.t1_running && ((via.reg_acr & 0x40) || !via.t1_fired))
+      Sched::Schedule(sys.sched, Sched::EV_VIA_T1, now + T1Counter(via, now));
+    else
+      Sched::Cancel(sys.sched, Sched::EV_VIA_T1);
+  }
+
+  static void ScheduleT2(System& sys, uint64_t now)
+  {
+    State& via = sys.via;
+    // ワンショットのみ
+    if (via.t2_running && !(via.reg_acr & 0x20) && !via.t2_fired)
+      Sched::Schedule(sys.sched, Sched::EV_VIA_T2, now + T2Counter(via, now));
+    else
+      Sched::Cancel(sys.sched, Sched::EV_VIA_T2);
+  }
+
+  static void ScheduleTimers(System& sys)
+  {
+    ScheduleT1(sys, sys.sched.now);
+    ScheduleT2(sys, sys.sched.now);
+  }
+
   void Write(System& sys, uint16_t addr, uint8_t val)
   {
     uint8_t reg = addr & 0x0F;
     switch (reg)
     {
       case Reg::ORB:
+        // PS/2 はポートBのライン状態を見ているので、変更前までを反映しておく
+        Ps2::Sync(sys, sys.sched.now);
         sys.via.reg_orb = val;
+        Ps2::Reschedule(sys);
         // SDカードのCS制御へ委譲
         Sd::SetCs(sys, (val & 0b01000000) == 0);
         break;
 
-      case Reg::DDRB: sys.via.reg_ddrb = val; break;
-      case Reg::ACR:  sys.via.reg_acr = val;  break;
+      case Reg::DDRB:
+        Ps2::Sync(sys, sys.sched.now);
+        sys.via.reg_ddrb = val;
+        Ps2::Reschedule(sys);
+        break;
+
+      case Reg::ACR:
+        Rebase(sys);
+        sys.via.reg_acr = val;
+        ScheduleTimers(sys);
+        break;
+
       case Reg::PCR:  sys.via.reg_pcr = val;  break;
 
       case Reg::IER:
@@ -48,26 +132,34 @@ namespace Via
         break;
 
       case Reg::T1CL:
+        Rebase(sys); // ラッチはフリーランのリロード値
         sys.via.t1_latch_l = val;
+        ScheduleTimers(sys);
         break;
 
       case Reg::T1CH:
         sys.via.t1_latch_h = val;
-        sys.via.t1_cnt = (val << 8) | sys.via.t1_latch_l;
+        sys.via.t1_load = (val << 8) | sys.via.t1_latch_l;
+        sys.via.t1_load_cycle = sys.sched.now;
         sys.via.t1_running = true;
         sys.via.t1_fired = false;
         sys.via.reg_ifr &= ~0x40;  // IFR6クリア
         UpdateIrq(sys);
+        ScheduleTimers(sys);
         break;
 
       case Reg::T1LL:
+        Rebase(sys);
         sys.via.t1_latch_l = val;
+        ScheduleTimers(sys);
         break;
 
       case Reg::T1LH:
+        Rebase(sys);
         sys.via.t1_latch_h = val;
         sys.via.reg_ifr &= ~0x40;  // IFR6クリア
         UpdateIrq(sys);
+        ScheduleTimers(sys);
         break;
 
       case Reg::T2CL:
@@ -75,11 +167,13 @@ namespace Via
         break;
 
       case Reg::T2CH:
-        sys.via.t2_cnt = (val << 8) | sys.via.t2_latch_l;
+        sys.via.t2_load = (val << 8) | sys.via.t2_latch_l;
+        sys.via.t2_load_cycle = sys.sched.now;
         sys.via.t2_running = true;
         sys.via.t2_fired = false;
         sys.via.reg_ifr &= ~0x20;  // IFR5クリア
         UpdateIrq(sys);
+        ScheduleTimers(sys);
         break;
     }
   }
@@ -93,6 +187,7 @@ namespace Via
         {
           // 出力ピン: reg_orb の値、入力ピン: PS/2ライン状態
           // (PS/2ピン以外の入力ビットはプルアップ=1とする)
+          Ps2::Sync(sys, sys.sched.now);
           uint8_t ps2_bits = Ps2::GetPortBBits(sys.ps2);
           uint8_t input_mask = ~sys.via.reg_ddrb & Ps2::PS2_MASK;
           uint8_t result     = sys.via.reg_orb;
@@ -125,10 +220,10 @@ namespace Via
       case Reg::T1CL:
         sys.via.reg_ifr &= ~0x40;
         UpdateIrq(sys);
-        return (uint8_t)(sys.via.t1_cnt & 0xFF);
+        return (uint8_t)(T1Counter(sys.via, sys.sched.now) & 0xFF);
 
       case Reg::T1CH:
-        return (uint8_t)(sys.via.t1_cnt >> 8);
+        return (uint8_t)(T1Counter(sys.via, sys.sched.now) >> 8);
 
       case Reg::T1LL:
         return sys.via.t1_latch_l;
@@ -139,65 +234,45 @@ namespace Via
       case Reg::T2CL:
         sys.via.reg_ifr &= ~0x20;
         UpdateIrq(sys);
-        return (uint8_t)(sys.via.t2_cnt & 0xFF);
+        return (uint8_t)(T2Counter(sys.via, sys.sched.now) & 0xFF);
 
       case Reg::T2CH:
-        return (uint8_t)(sys.via.t2_cnt >> 8);
+        return (uint8_t)(T2Counter(sys.via, sys.sched.now) >> 8);
     }
     return 0;
   }
-  void Tick(System& sys)
+
+  // タイマカウンタは時刻で変わり、T1CL/T2CL/SR は読むとフラグをクリアする
+  // (SR は SPI 転送も行う)。ORB の PS/2 ラインは EV_PS2 イベントでしか変わらない
+  bool IsPureRead(uint16_t addr)
   {
-    // === Timer 1 ===
-    if (sys.via.t1_running)
+    switch (addr & 0x0F)
     {
-      if (sys.via.t1_cnt == 0)
-      {
-        bool freerun = (sys.via.reg_acr & 0x40); // ACR bit6
-
-        if (freerun)
-        {
-          // フリーラン: 毎回割り込み発生、ラッチからリロード
-          sys.via.reg_ifr |= 0x40;
-          UpdateIrq(sys);
-          sys.via.t1_cnt = (sys.via.t1_latch_h << 8) | sys.via.t1_latch_l;
-        }
-        else
-        {
-          // ワンショット: 最初の1回だけ割り込み
-          if (!sys.via.t1_fired)
-          {
-            sys.via.reg_ifr |= 0x40;
-            UpdateIrq(sys);
-            sys.via.t1_fired = true;
-          }
-          sys.via.t1_cnt = 0xFFFF; // ロールオーバーして回り続ける
-        }
-      }
-      else
-      {
-        sys.via.t1_cnt--;
-      }
+      case Reg::T1CL: case Reg::T1CH:
+      case Reg::T2CL: case Reg::T2CH:
+      case Reg::SR:
+        return false;
     }
+    return true;
+  }
 
-    // === Timer 2 ===
-    if (sys.via.t2_running && !(sys.via.reg_acr & 0x20))
-    {
-      if (sys.via.t2_cnt == 0)
-      {
-        if (!sys.via.t2_fired)
-        {
-          sys.via.reg_ifr |= 0x20;
-          UpdateIrq(sys);
-          sys.via.t2_fired = true;
-        }
-        sys.via.t2_cnt = 0xFFFF;
-      }
-      else
-      {
-        sys.via.t2_cnt--;
-      }
-    }
+  // タイマ1満了イベント (cycle = カウンタ0を見たサイクル)
+  void OnTimer1(System& sys, uint64_t cycle)
+  {
+    // フリーラン: 毎回割り込み発生 / ワンショット: 最初の1回だけ (未発火の間しか登録されない)
+    sys.via.reg_ifr |= 0x40;
+    if (!(sys.via.reg_acr & 0x40)) sys.via.t1_fired = true;
+    UpdateIrq(sys);
+    ScheduleT1(sys, cycle + 1);
+  }
+
+  // タイマ2満了イベント
+  void OnTimer2(System& sys, uint64_t cycle)
+  {
+    sys.via.reg_ifr |= 0x20;
+    sys.via.t2_fired = true;
+    UpdateIrq(sys);
+    ScheduleT2(sys, cycle + 1);
   }
 
 }
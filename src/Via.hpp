@@ -40,13 +40,16 @@ namespace Fxt
       uint8_t reg_pcr = 0;
       uint8_t reg_ddrb = 0;
 
-      uint16_t t1_cnt = 0;    // T1カウンタ
+      // カウンタは毎サイクル減算せず、ロードしたサイクルと値から読み出し時に計算する
+      uint16_t t1_load = 0;         // T1ロード値
+      uint64_t t1_load_cycle = 0;   // T1ロードサイクル
       uint8_t t1_latch_l = 0; // T1ラッチ下位
       uint8_t t1_latch_h = 0; // T1ラッチ上位
       bool    t1_running = false;   // カウント中か
       bool    t1_fired = false;     // 一度発火したか
 
-      uint16_t t2_cnt = 0;    // T2カウンタ
+      uint16_t t2_load = 0;         // T2ロード値
+      uint64_t t2_load_cycle = 0;   // T2ロードサイクル
       uint8_t t2_latch_l = 0; // T2ラッチ下位
       bool    t2_running = false;   // カウント中か
       bool    t2_fired = false;     // 一度発火したか
@@ -55,7 +58,11 @@ namespace Fxt
     // 操作関数
     void Write(System& sys, uint16_t addr, uint8_t val);
     uint8_t Read(System& sys, uint16_t addr);
-    void Tick(System& sys);
+    // Read に副作用がなく、次のイベントまで値が変わらないレジスタか
+    bool IsPureRead(uint16_t addr);
+    // タイマ満了イベント (スケジューラから呼ばれる)
+    void OnTimer1(System& sys, uint64_t cycle);
+    void OnTimer2(System& sys, uint64_t cycle);
 
   }
 
@@ -0,0 +1,917 @@
+/* src/W65c02.hpp - W65C02 CPUコア (バスをテンプレートで束縛する実装)
+ *
+ * リファレンスの vrEmu6502 (CPU_W65C02) と命令単位で同一の動作をする。
+ *   - バスアクセスは命令の先頭サイクルでまとめて行う
+ *   - 割り込み受付は1サイクル
+ *   - 1サイクルNOP (未定義命令) の直後は割り込みを受け付けない
+ *   - WAI / STP 中は1回の呼び出しが1サイクル
+ *
+ * Bus は次のメンバ関数を持つ型。呼び出しはすべてインライン展開される:
+ *   uint8_t Read(uint16_t addr);
+ *   void    Write(uint16_t addr, uint8_t val);
+ *   uint8_t Fetch(uint16_t addr);  // 命令バイト (オペコード・オペランド) の読み出し
+ *   bool    PureRead(uint16_t addr); // 読み出しに副作用がなく、次のイベントまで値が変わらないか
+ * Fetch は通常 Read と同じでよい。デコード済みの命令を実行するバスはここで保持値を返す。
+ * PureRead は待機ループの検出 (IdleLoop) でだけ使う。
+ *
+ * 命令表は constexpr で、命令ごとに Execute<Bus, opcode> が実体化されるため
+ * 命令種別・アドレッシングモードの分岐はコンパイル時に畳み込まれる。
+ */
+#pragma once
+#include <cstdint>
+
+// 命令ディスパッチ方式 (1 = labels-as-values による threaded dispatch, 0 = switch)
+#ifndef FXT_W65C02_THREADED
+#  if defined(__GNUC__) && !defined(__EMSCRIPTEN__)
+#    define FXT_W65C02_THREADED 1
+#  else
+#    define FXT_W65C02_THREADED 0
+#  endif
+#endif
+
+namespace Fxt
+{
+namespace W65c02
+{
+  // ステータスフラグ
+  enum Flag : uint8_t
+  {
+    FLAG_C = 0x01, // Carry
+    FLAG_Z = 0x02, // Zero
+    FLAG_I = 0x04, // IRQ Disable
+    FLAG_D = 0x08, // Decimal
+    FLAG_B = 0x10, // Break
+    FLAG_U = 0x20, // 未使用 (常に1)
+    FLAG_V = 0x40, // oVerflow
+    FLAG_N = 0x80  // Negative
+  };
+
+  // 命令 (RMB/SMB/BBR/BBS のビット番号はオペコード上位から求める)
+  enum Op : uint8_t
+  {
+    ADC, AND, ASL, BBR, BBS, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRA, BRK,
+    BVC, BVS, CLC, CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC,
+    INX, INY, JMP, JSR, LDA, LDD, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PHX,
+    PHY, PLA, PLP, PLX, PLY, RMB, ROL, ROR, RTI, RTS, SBC, SEC, SED, SEI,
+    SMB, STA, STP, STX, STY, STZ, TAX, TAY, TRB, TSB, TSX, TXA, TXS, TYA,
+    WAI
+  };
+
+  // アドレッシングモード
+  enum Mode : uint8_t
+  {
+    IMP,  // 暗黙
+    ACC,  // アキュムレータ
+    IMM,  // #$12
+    ZP,   // $12
+    ZPX,  // $12,X
+    ZPY,  // $12,Y
+    ZPI,  // ($12)
+    XIN,  // ($12,X)
+    YIN,  // ($12),Y
+    YIP,  // ($12),Y  ページ跨ぎで+1サイクル
+    AB,   // $1234
+    ABX,  // $1234,X
+    ABY,  // $1234,Y
+    AXP,  // $1234,X  ページ跨ぎで+1サイクル
+    AYP,  // $1234,Y  ページ跨ぎで+1サイクル
+    IND,  // ($1234)      JMP専用
+    INDX, // ($1234,X)    JMP専用
+    REL   // 相対分岐
+  };
+
+  struct Opcode
+  {
+    Op      op;
+    Mode    mode;
+    uint8_t cycles; // 基本サイクル数
+  };
+
+  // W65C02 命令表
+  constexpr Opcode OPCODES[256] = {
+    /* 0_ */ {BRK, IMP, 7}, {ORA, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {TSB, ZP, 5}, {ORA, ZP, 3}, {ASL, ZP, 5}, {RMB, ZP, 5}, {PHP, IMP, 3}, {ORA, IMM, 2}, {ASL, ACC, 2}, {NOP, IMP, 1}, {TSB, AB, 6}, {ORA, AB, 4}, {ASL, AB, 6}, {BBR, ZP, 5},
+    /* 1_ */ {BPL, REL, 2}, {ORA, YIP, 5}, {ORA, ZPI, 5}, {NOP, IMP, 1}, {TRB, ZP, 5}, {ORA, ZPX, 4}, {ASL, ZPX, 6}, {RMB, ZP, 5}, {CLC, IMP, 2}, {ORA, AYP, 4}, {INC, ACC, 2}, {NOP, IMP, 1}, {TRB, AB, 6}, {ORA, AXP, 4}, {ASL, AXP, 6}, {BBR, ZP, 5},
+    /* 2_ */ {JSR, AB, 6}, {AND, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {BIT, ZP, 3}, {AND, ZP, 3}, {ROL, ZP, 5}, {RMB, ZP, 5}, {PLP, IMP, 4}, {AND, IMM, 2}, {ROL, ACC, 2}, {NOP, IMP, 1}, {BIT, AB, 4}, {AND, AB, 4}, {ROL, AB, 6}, {BBR, ZP, 5},
+    /* 3_ */ {BMI, REL, 2}, {AND, YIP, 5}, {AND, ZPI, 5}, {NOP, IMP, 1}, {BIT, ZPX, 4}, {AND, ZPX, 4}, {ROL, ZPX, 6}, {RMB, ZP, 5}, {SEC, IMP, 2}, {AND, AYP, 4}, {DEC, ACC, 2}, {NOP, IMP, 1}, {BIT, ABX, 4}, {AND, AXP, 4}, {ROL, AXP, 6}, {BBR, ZP, 5},
+    /* 4_ */ {RTI, IMP, 6}, {EOR, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {LDD, ZP, 3}, {EOR, ZP, 3}, {LSR, ZP, 5}, {RMB, ZP, 5}, {PHA, IMP, 3}, {EOR, IMM, 2}, {LSR, ACC, 2}, {NOP, IMP, 1}, {JMP, AB, 3}, {EOR, AB, 4}, {LSR, AB, 6}, {BBR, ZP, 5},
+    /* 5_ */ {BVC, REL, 2}, {EOR, YIP, 5}, {EOR, ZPI, 5}, {NOP, IMP, 1}, {LDD, ZPX, 4}, {EOR, ZPX, 4}, {LSR, ZPX, 6}, {RMB, ZP, 5}, {CLI, IMP, 2}, {EOR, AYP, 4}, {PHY, IMP, 3}, {NOP, IMP, 1}, {LDD, AB, 8}, {EOR, AXP, 4}, {LSR, AXP, 6}, {BBR, ZP, 5},
+    /* 6_ */ {RTS, IMP, 6}, {ADC, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {STZ, ZP, 3}, {ADC, ZP, 3}, {ROR, ZP, 5}, {RMB, ZP, 5}, {PLA, IMP, 4}, {ADC, IMM, 2}, {ROR, ACC, 2}, {NOP, IMP, 1}, {JMP, IND, 6}, {ADC, AB, 4}, {ROR, AB, 6}, {BBR, ZP, 5},
+    /* 7_ */ {BVS, REL, 2}, {ADC, YIP, 5}, {ADC, ZPI, 5}, {NOP, IMP, 1}, {STZ, ZPX, 4}, {ADC, ZPX, 4}, {ROR, ZPX, 6}, {RMB, ZP, 5}, {SEI, IMP, 2}, {ADC, AYP, 4}, {PLY, IMP, 4}, {NOP, IMP, 1}, {JMP, INDX, 6}, {ADC, AXP, 4}, {ROR, AXP, 6}, {BBR, ZP, 5},
+    /* 8_ */ {BRA, REL, 2}, {STA, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {STY, ZP, 3}, {STA, ZP, 3}, {STX, ZP, 3}, {SMB, ZP, 5}, {DEY, IMP, 2}, {BIT, IMM, 2}, {TXA, IMP, 2}, {NOP, IMP, 1}, {STY, AB, 4}, {STA, AB, 4}, {STX, AB, 4}, {BBS, ZP, 5},
+    /* 9_ */ {BCC, REL, 2}, {STA, YIN, 6}, {STA, ZPI, 5}, {NOP, IMP, 1}, {STY, ZPX, 4}, {STA, ZPX, 4}, {STX, ZPY, 4}, {SMB, ZP, 5}, {TYA, IMP, 2}, {STA, ABY, 5}, {TXS, IMP, 2}, {NOP, IMP, 1}, {STZ, AB, 4}, {STA, ABX, 5}, {STZ, ABX, 5}, {BBS, ZP, 5},
+    /* A_ */ {LDY, IMM, 2}, {LDA, XIN, 6}, {LDX, IMM, 2}, {NOP, IMP, 1}, {LDY, ZP, 3}, {LDA, ZP, 3}, {LDX, ZP, 3}, {SMB, ZP, 5}, {TAY, IMP, 2}, {LDA, IMM, 2}, {TAX, IMP, 2}, {NOP, IMP, 1}, {LDY, AB, 4}, {LDA, AB, 4}, {LDX, AB, 4}, {BBS, ZP, 5},
+    /* B_ */ {BCS, REL, 2}, {LDA, YIP, 5}, {LDA, ZPI, 5}, {NOP, IMP, 1}, {LDY, ZPX, 4}, {LDA, ZPX, 4}, {LDX, ZPY, 4}, {SMB, ZP, 5}, {CLV, IMP, 2}, {LDA, AYP, 4}, {TSX, IMP, 2}, {NOP, IMP, 1}, {LDY, AXP, 4}, {LDA, AXP, 4}, {LDX, AYP, 4}, {BBS, ZP, 5},
+    /* C_ */ {CPY, IMM, 2}, {CMP, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {CPY, ZP, 3}, {CMP, ZP, 3}, {DEC, ZP, 5}, {SMB, ZP, 5}, {INY, IMP, 2}, {CMP, IMM, 2}, {DEX, IMP, 2}, {WAI, IMP, 3}, {CPY, AB, 4}, {CMP, AB, 4}, {DEC, AB, 6}, {BBS, ZP, 5},
+    /* D_ */ {BNE, REL, 2}, {CMP, YIP, 5}, {CMP, ZPI, 5}, {NOP, IMP, 1}, {LDD, ZPX, 4}, {CMP, ZPX, 4}, {DEC, ZPX, 6}, {SMB, ZP, 5}, {CLD, IMP, 2}, {CMP, AYP, 4}, {PHX, IMP, 3}, {STP, IMP, 3}, {LDD, AB, 4}, {CMP, AXP, 4}, {DEC, ABX, 7}, {BBS, ZP, 5},
+    /* E_ */ {CPX, IMM, 2}, {SBC, XIN, 6}, {LDD, IMM, 2}, {NOP, IMP, 1}, {CPX, ZP, 3}, {SBC, ZP, 3}, {INC, ZP, 5}, {SMB, ZP, 5}, {INX, IMP, 2}, {SBC, IMM, 2}, {NOP, IMP, 2}, {NOP, IMP, 1}, {CPX, AB, 4}, {SBC, AB, 4}, {INC, AB, 6}, {BBS, ZP, 5},
+    /* F_ */ {BEQ, REL, 2}, {SBC, YIP, 5}, {SBC, ZPI, 5}, {NOP, IMP, 1}, {LDD, ZPX, 4}, {SBC, ZPX, 4}, {INC, ZPX, 6}, {SMB, ZP, 5}, {SED, IMP, 2}, {SBC, AYP, 4}, {PLX, IMP, 4}, {NOP, IMP, 1}, {LDD, AB, 4}, {SBC, AXP, 4}, {INC, ABX, 7}, {BBS, ZP, 5}
+  };
+
+  static constexpr uint16_t NMI_VEC   = 0xFFFA;
+  static constexpr uint16_t RESET_VEC = 0xFFFC;
+  static constexpr uint16_t IRQ_VEC   = 0xFFFE;
+
+  // CPU状態
+  struct State
+  {
+    // レジスタ
+    uint16_t pc = 0;
+    uint8_t  a  = 0;
+    uint8_t  x  = 0;
+    uint8_t  y  = 0;
+    uint8_t  sp = 0;
+    uint8_t  p  = FLAG_U | FLAG_B;
+
+    // 割り込み入力
+    bool irq = false; // IRQ線 (レベル, true=要求中)
+    bool nmi = false; // NMI要求 (受付でクリア)
+
+    bool wai = false; // WAI で割り込み待ち
+    bool stp = false; // STP で停止中
+
+    uint8_t  opcode      = 0; // 最後に実行した命令
+    uint16_t opcode_addr = 0; // そのアドレス
+    uint8_t  step        = 0; // Tick 用: 実行中命令の残りサイクル
+
+    uint64_t idle_skipped  = 0; // 統計: 待機ループの検出で飛ばしたサイクル数
+    uint64_t delay_skipped = 0; // 統計: 遅延ループをまとめて進めたサイクル数
+  };
+
+  // ---------------------------------------------------------------
+  //  ヘルパ
+  // ---------------------------------------------------------------
+  inline void SetFlag(State& cpu, uint8_t flag, bool set)
+  {
+    cpu.p = set ? (cpu.p | flag) : (cpu.p & ~flag);
+  }
+
+  inline void SetNZ(State& cpu, uint8_t val)
+  {
+    cpu.p = (cpu.p & ~(FLAG_N | FLAG_Z)) | (val & FLAG_N) | (val ? 0 : FLAG_Z);
+  }
+
+  template <class Bus>
+  inline uint16_t Read16(Bus& bus, uint16_t addr)
+  {
+    uint8_t lo = bus.Read(addr);
+    return lo | (bus.Read((uint16_t)(addr + 1)) << 8);
+  }
+
+  // ゼロページ内で上位バイトを折り返す
+  template <class Bus>
+  inline uint16_t Read16Zp(Bus& bus, uint8_t addr)
+  {
+    uint8_t lo = bus.Read(addr);
+    return lo | (bus.Read((uint8_t)(addr + 1)) << 8);
+  }
+
+  // 命令バイト列から16ビット読み出し
+  template <class Bus>
+  inline uint16_t Fetch16(Bus& bus, uint16_t addr)
+  {
+    uint8_t lo = bus.Fetch(addr);
+    return lo | (bus.Fetch((uint16_t)(addr + 1)) << 8);
+  }
+
+  template <class Bus>
+  inline void Push(State& cpu, Bus& bus, uint8_t val)
+  {
+    bus.Write(0x100 | cpu.sp--, val);
+  }
+
+  template <class Bus>
+  inline uint8_t Pop(State& cpu, Bus& bus)
+  {
+    return bus.Read(0x100 | ++cpu.sp);
+  }
+
+  // 実効アドレス計算 (ページ跨ぎ等のサイクル加算を cycles に反映)
+  template <Mode MODE, class Bus>
+  inline uint16_t Address(State& cpu, Bus& bus, uint8_t& cycles)
+  {
+    switch (MODE)
+    {
+      case IMM: return cpu.pc++;
+      case ZP:  return bus.Fetch(cpu.pc++);
+      case ZPX: return (uint8_t)(bus.Fetch(cpu.pc++) + cpu.x);
+      case ZPY: return (uint8_t)(bus.Fetch(cpu.pc++) + cpu.y);
+      case ZPI: return Read16Zp(bus, bus.Fetch(cpu.pc++));
+      case XIN: return Read16Zp(bus, (uint8_t)(bus.Fetch(cpu.pc++) + cpu.x));
+      case YIN: return (uint16_t)(Read16Zp(bus, bus.Fetch(cpu.pc++)) + cpu.y);
+      case YIP:
+        {
+          uint16_t base = Read16Zp(bus, bus.Fetch(cpu.pc++));
+          uint16_t addr = base + cpu.y;
+          cycles += ((base ^ addr) & 0xFF00) != 0;
+          return addr;
+        }
+      case AB:
+        {
+          uint16_t addr = Fetch16(bus, cpu.pc);
+          cpu.pc += 2;
+          return addr;
+        }
+      case ABX:
+      case ABY:
+      case AXP:
+      case AYP:
+        {
+          uint16_t base = Fetch16(bus, cpu.pc);
+          cpu.pc += 2;
+          uint16_t addr = base + ((MODE == ABX || MODE == AXP) ? cpu.x : cpu.y);
+          if (MODE == AXP || MODE == AYP) cycles += ((base ^ addr) & 0xFF00) != 0;
+          return addr;
+        }
+      case IND:
+        {
+          uint16_t ptr = Fetch16(bus, cpu.pc++);
+          return Read16(bus, ptr);
+        }
+      case INDX:
+        {
+          uint16_t ptr = Fetch16(bus, cpu.pc++) + cpu.x;
+          return Read16(bus, ptr);
+        }
+      case REL:
+        {
+          int8_t offset = (int8_t)bus.Fetch(cpu.pc);
+          return cpu.pc++ + offset + 1;
+        }
+      default:
+        return 0;
+    }
+  }
+
+  // オペランドの値 (即値は命令バイト、それ以外は実効アドレスから読む)
+  template <Mode MODE, class Bus>
+  inline uint8_t Load(State& cpu, Bus& bus, uint8_t& cycles)
+  {
+    if (MODE == IMM) return bus.Fetch(cpu.pc++);
+    return bus.Read(Address<MODE>(cpu, bus, cycles));
+  }
+
+  // 条件分岐 (成立で+1、ページ跨ぎでさらに+1)
+  template <class Bus>
+  inline void Branch(State& cpu, Bus& bus, bool taken, uint8_t& cycles)
+  {
+    uint16_t addr = Address<REL>(cpu, bus, cycles);
+    if (!taken) return;
+    cycles += 1 + (((cpu.pc ^ addr) & 0xFF00) != 0);
+    cpu.pc = addr;
+  }
+
+  // 比較
+  inline void Compare(State& cpu, uint8_t reg, uint8_t val)
+  {
+    uint16_t result = reg + (uint8_t)~val + 1;
+    SetFlag(cpu, FLAG_C, result > 0xFF);
+    SetNZ(cpu, (uint8_t)result);
+  }
+
+  // 加算 (10進モードは65C02の1サイクル加算とフラグ計算を含む)
+  inline void Adc(State& cpu, uint8_t value, uint8_t& cycles)
+  {
+    bool carry = cpu.p & FLAG_C;
+    if (!(cpu.p & FLAG_D))
+    {
+      uint16_t result = cpu.a + value + carry;
+      SetFlag(cpu, FLAG_C, result > 0xFF);
+      SetFlag(cpu, FLAG_V, (cpu.a ^ result) & (value ^ result) & 0x80);
+      SetNZ(cpu, cpu.a = (uint8_t)result);
+      return;
+    }
+
+    uint8_t vu = value & 0x0F;
+    uint8_t vt = (value & 0xF0) >> 4;
+    uint8_t au = cpu.a & 0x0F;
+    uint8_t at = (cpu.a & 0xF0) >> 4;
+
+    uint8_t units = vu + au + carry;
+    uint8_t tens  = vt + at;
+    uint8_t tc    = 0;
+
+    if (units > 0x09)
+    {
+      tc = 1;
+      tens  += 0x01;
+      units += 0x06;
+    }
+    if (tens > 0x09) tens += 0x06;
+
+    ++cycles;
+
+    if (at & 0x08) at |= 0xF0;
+    if (vt & 0x08) vt |= 0xF0;
+    int8_t res = (int8_t)(at + vt + tc);
+    SetFlag(cpu, FLAG_V, res < -8 || res > 7);
+
+    SetNZ(cpu, cpu.a = (uint8_t)((tens << 4) | (units & 0x0F)));
+    SetFlag(cpu, FLAG_C, tens & 0xF0);
+  }
+
+  // 減算
+  inline void Sbc(State& cpu, uint8_t value, uint8_t& cycles)
+  {
+    bool carry = cpu.p & FLAG_C;
+    if (!(cpu.p & FLAG_D))
+    {
+      uint8_t  opr    = ~value;
+      uint16_t result = cpu.a + opr + carry;
+      SetFlag(cpu, FLAG_C, result > 0xFF);
+      SetFlag(cpu, FLAG_V, (cpu.a ^ result) & (opr ^ result) & 0x80);
+      SetNZ(cpu, cpu.a = (uint8_t)result);
+      return;
+    }
+
+    uint16_t bin_result = cpu.a + ~value + carry;
+    uint16_t tmp    = (cpu.a & 0x0F) - (value & 0x0F) - !carry;
+    uint16_t result = cpu.a - value - !carry;
+    if (result & 0x8000) result -= 0x60;
+    if (tmp & 0x8000)    result -= 0x06;
+
+    ++cycles;
+
+    SetFlag(cpu, FLAG_V, (cpu.a ^ bin_result) & (~value ^ bin_result) & 0x80);
+    SetNZ(cpu, (uint8_t)result);
+    SetFlag(cpu, FLAG_C, (uint16_t)result <= (uint16_t)cpu.a || (result & 0xFF0) == 0xFF0);
+    cpu.a = result & 0xFF;
+  }
+
+  // 割り込み受付
+  template <class Bus>
+  inline void Interrupt(State& cpu, Bus& bus, uint16_t vec)
+  {
+    Push(cpu, bus, cpu.pc >> 8);
+    Push(cpu, bus, cpu.pc & 0xFF);
+    Push(cpu, bus, (cpu.p | FLAG_U) & ~FLAG_B);
+    cpu.p |= FLAG_I;
+    cpu.wai = false;
+    cpu.pc = Read16(bus, vec);
+  }
+
+  // ---------------------------------------------------------------
+  //  命令実行 (オペコードごとに実体化)
+  // ---------------------------------------------------------------
+  template <class Bus, int OPC>
+  inline uint8_t Execute(State& cpu, Bus& bus)
+  {
+    constexpr Op      op     = OPCODES[OPC].op;
+    constexpr Mode    mode   = OPCODES[OPC].mode;
+    constexpr uint8_t bit    = 1 << ((OPC >> 4) & 7); // RMB/SMB/BBR/BBS
+    uint8_t           cycles = OPCODES[OPC].cycles;
+
+    switch (op)
+    {
+      // --- ロード・ストア ---
+      case LDA: SetNZ(cpu, cpu.a = Load<mode>(cpu, bus, cycles)); break;
+      case LDX: SetNZ(cpu, cpu.x = Load<mode>(cpu, bus, cycles)); break;
+      case LDY: SetNZ(cpu, cpu.y = Load<mode>(cpu, bus, cycles)); break;
+      case STA: bus.Write(Address<mode>(cpu, bus, cycles), cpu.a); break;
+      case STX: bus.Write(Address<mode>(cpu, bus, cycles), cpu.x); break;
+      case STY: bus.Write(Address<mode>(cpu, bus, cycles), cpu.y); break;
+      case STZ: bus.Write(Address<mode>(cpu, bus, cycles), 0);     break;
+
+      // --- 演算 ---
+      case ADC: Adc(cpu, Load<mode>(cpu, bus, cycles), cycles); break;
+      case SBC: Sbc(cpu, Load<mode>(cpu, bus, cycles), cycles); break;
+      case AND: SetNZ(cpu, cpu.a &= Load<mode>(cpu, bus, cycles)); break;
+      case ORA: SetNZ(cpu, cpu.a |= Load<mode>(cpu, bus, cycles)); break;
+      case EOR: SetNZ(cpu, cpu.a ^= Load<mode>(cpu, bus, cycles)); break;
+      case CMP: Compare(cpu, cpu.a, Load<mode>(cpu, bus, cycles)); break;
+      case CPX: Compare(cpu, cpu.x, Load<mode>(cpu, bus, cycles)); break;
+      case CPY: Compare(cpu, cpu.y, Load<mode>(cpu, bus, cycles)); break;
+      case BIT:
+        {
+          uint8_t val = Load<mode>(cpu, bus, cycles);
+          if (mode != IMM)
+          {
+            SetFlag(cpu, FLAG_V, val & 0x40);
+            SetFlag(cpu, FLAG_N, val & 0x80);
+          }
+          SetFlag(cpu, FLAG_Z, !(val & cpu.a));
+        }
+        break;
+
+      // --- シフト・インクリメント (アキュムレータ / メモリ) ---
+      case ASL:
+      case LSR:
+      case ROL:
+      case ROR:
+      case INC:
+      case DEC:
+        {
+          uint16_t addr = 0;
+          uint8_t  val;
+          if (mode == ACC) val = cpu.a;
+          else             val = bus.Read(addr = Address<mode>(cpu, bus, cycles));
+
+          bool carry = cpu.p & FLAG_C;
+          switch (op)
+          {
+            case ASL: SetFlag(cpu, FLAG_C, val & 0x80); val <<= 1; break;
+            case LSR: SetFlag(cpu, FLAG_C, val & 0x01); val >>= 1; break;
+            case ROL: SetFlag(cpu, FLAG_C, val & 0x80); val = (val << 1) | carry; break;
+            case ROR: SetFlag(cpu, FLAG_C, val & 0x01); val = (val >> 1) | (carry * 0x80); break;
+            case INC: ++val; break;
+            default:  --val; break;
+          }
+          SetNZ(cpu, val);
+
+          if (mode == ACC) cpu.a = val;
+          else             bus.Write(addr, val);
+        }
+        break;
+
+      case INX: SetNZ(cpu, ++cpu.x); break;
+      case INY: SetNZ(cpu, ++cpu.y); break;
+      case DEX: SetNZ(cpu, --cpu.x); break;
+      case DEY: SetNZ(cpu, --cpu.y); break;
+
+      case TRB:
+      case TSB:
+        {
+          uint16_t addr = Address<mode>(cpu, bus, cycles);
+          uint8_t  temp = bus.Read(addr);
+          bus.Write(addr, op == TRB ? (temp & ~cpu.a) : (temp | cpu.a));
+          SetFlag(cpu, FLAG_Z, !(temp & cpu.a));
+        }
+        break;
+
+      case RMB:
+      case SMB:
+        {
+          uint16_t addr = Address<mode>(cpu, bus, cycles);
+          uint8_t  val  = bus.Read(addr);
+          bus.Write(addr, op == RMB ? (val & ~bit) : (val | bit));
+        }
+        break;
+
+      // --- 転送 ---
+      case TAX: SetNZ(cpu, cpu.x = cpu.a);  break;
+      case TAY: SetNZ(cpu, cpu.y = cpu.a);  break;
+      case TXA: SetNZ(cpu, cpu.a = cpu.x);  break;
+      case TYA: SetNZ(cpu, cpu.a = cpu.y);  break;
+      case TSX: SetNZ(cpu, cpu.x = cpu.sp); break;
+      case TXS: cpu.sp = cpu.x;             break;
+
+      // --- スタック ---
+      case PHA: Push(cpu, bus, cpu.a); break;
+      case PHX: Push(cpu, bus, cpu.x); break;
+      case PHY: Push(cpu, bus, cpu.y); break;
+      case PHP: Push(cpu, bus, cpu.p | FLAG_B | FLAG_U); break;
+      case PLA: SetNZ(cpu, cpu.a = Pop(cpu, bus)); break;
+      case PLX: SetNZ(cpu, cpu.x = Pop(cpu, bus)); break;
+      case PLY: SetNZ(cpu, cpu.y = Pop(cpu, bus)); break;
+      case PLP: cpu.p = Pop(cpu, bus) | FLAG_U | FLAG_B; break;
+
+      // --- フラグ ---
+      case CLC: cpu.p &= ~FLAG_C; break;
+      case CLD: cpu.p &= ~FLAG_D; break;
+      case CLI: cpu.p &= ~FLAG_I; break;
+      case CLV: cpu.p &= ~FLAG_V; break;
+      case SEC: cpu.p |= FLAG_C;  break;
+      case SED: cpu.p |= FLAG_D;  break;
+      case SEI: cpu.p |= FLAG_I;  break;
+
+      // --- 分岐 ---
+      case BRA: Branch(cpu, bus, true,                  cycles); break;
+      case BCC: Branch(cpu, bus, !(cpu.p & FLAG_C),     cycles); break;
+      case BCS: Branch(cpu, bus, (cpu.p & FLAG_C) != 0, cycles); break;
+      case BNE: Branch(cpu, bus, !(cpu.p & FLAG_Z),     cycles); break;
+      case BEQ: Branch(cpu, bus, (cpu.p & FLAG_Z) != 0, cycles); break;
+      case BPL: Branch(cpu, bus, !(cpu.p & FLAG_N),     cycles); break;
+      case BMI: Branch(cpu, bus, (cpu.p & FLAG_N) != 0, cycles); break;
+      case BVC: Branch(cpu, bus, !(cpu.p & FLAG_V),     cycles); break;
+      case BVS: Branch(cpu, bus, (cpu.p & FLAG_V) != 0, cycles); break;
+
+      case BBR:
+      case BBS:
+        {
+          // 分岐成立でもサイクル加算なし
+          uint8_t val = Load<mode>(cpu, bus, cycles);
+          bool taken = (op == BBR) ? !(val & bit) : (val & bit) != 0;
+          if (taken) cpu.pc = Address<REL>(cpu, bus, cycles);
+          else       ++cpu.pc;
+        }
+        break;
+
+      // --- ジャンプ・サブルーチン ---
+      case JMP: cpu.pc = Address<mode>(cpu, bus, cycles); break;
+      case JSR:
+        {
+          uint16_t addr = Address<mode>(cpu, bus, cycles);
+          --cpu.pc;
+          Push(cpu, bus, cpu.pc >> 8);
+          Push(cpu, bus, cpu.pc & 0xFF);
+          cpu.pc = addr;
+        }
+        break;
+      case RTS:
+        {
+          uint8_t lo = Pop(cpu, bus);
+          cpu.pc = (lo | (Pop(cpu, bus) << 8)) + 1;
+        }
+        break;
+      case RTI:
+        {
+          cpu.p = Pop(cpu, bus) | FLAG_U | FLAG_B;
+          uint8_t lo = Pop(cpu, bus);
+          cpu.pc = lo | (Pop(cpu, bus) << 8);
+        }
+        break;
+      case BRK:
+        ++cpu.pc;
+        Push(cpu, bus, cpu.pc >> 8);
+        Push(cpu, bus, cpu.pc & 0xFF);
+        Push(cpu, bus, cpu.p | FLAG_U | FLAG_B);
+        cpu.p |= FLAG_I;
+        cpu.p &= ~FLAG_D;
+        cpu.pc = Read16(bus, IRQ_VEC);
+        break;
+
+      // --- その他 ---
+      case NOP: if (mode != IMP) Address<mode>(cpu, bus, cycles); break;
+      case LDD: if (mode != IMP) Load<mode>(cpu, bus, cycles); break; // 読み捨て
+      case WAI: cpu.wai = true; break;
+      case STP: cpu.stp = true; break;
+    }
+    return cycles;
+  }
+
+  // 全オペコードの列挙 X(0x00) ... X(0xFF) (switch の case やラベル名の生成用)
+#define FXT_W65C02_ROW(X, h) \
+  X(h##0) X(h##1) X(h##2) X(h##3) X(h##4) X(h##5) X(h##6) X(h##7) \
+  X(h##8) X(h##9) X(h##A) X(h##B) X(h##C) X(h##D) X(h##E) X(h##F)
+#define FXT_W65C02_ALL(X) \
+  FXT_W65C02_ROW(X, 0x0) FXT_W65C02_ROW(X, 0x1) FXT_W65C02_ROW(X, 0x2) FXT_W65C02_ROW(X, 0x3) \
+  FXT_W65C02_ROW(X, 0x4) FXT_W65C02_ROW(X, 0x5) FXT_W65C02_ROW(X, 0x6) FXT_W65C02_ROW(X, 0x7) \
+  FXT_W65C02_ROW(X, 0x8) FXT_W65C02_ROW(X, 0x9) FXT_W65C02_ROW(X, 0xA) FXT_W65C02_ROW(X, 0xB) \
+  FXT_W65C02_ROW(X, 0xC) FXT_W65C02_ROW(X, 0xD) FXT_W65C02_ROW(X, 0xE) FXT_W65C02_ROW(X, 0xF)
+
+  // オペコードで分岐 (各 case は命令ごとに特殊化された Execute をインライン展開)
+  template <class Bus>
+  inline uint8_t Dispatch(State& cpu, Bus& bus, uint8_t opcode)
+  {
+#define FXT_W65C02_CASE(n) case n: return Execute<Bus, n>(cpu, bus);
+    switch (opcode)
+    {
+      FXT_W65C02_ALL(FXT_W65C02_CASE)
+    }
+#undef FXT_W65C02_CASE
+    return 1;
+  }
+
+  // 命令境界での1ステップ: 割り込み受付・WAI待ち・命令実行のいずれか
+  template <class Bus>
+  inline uint8_t Step(State& cpu, Bus& bus)
+  {
+    // 1サイクルNOPの直後は割り込みを見ない
+    if (OPCODES[cpu.opcode].cycles != 1)
+    {
+      if (cpu.nmi)
+      {
+        cpu.nmi = false;
+        Interrupt(cpu, bus, NMI_VEC);
+        return 1;
+      }
+      if (cpu.irq)
+      {
+        cpu.wai = false;
+        if (!(cpu.p & FLAG_I))
+        {
+          Interrupt(cpu, bus, IRQ_VEC);
+          return 1;
+        }
+      }
+    }
+    if (cpu.wai) return 1;
+
+    cpu.opcode_addr = cpu.pc++;
+    cpu.opcode      = bus.Fetch(cpu.opcode_addr);
+    return Dispatch(cpu, bus, cpu.opcode);
+  }
+
+  // ---------------------------------------------------------------
+  //  公開API
+  // ---------------------------------------------------------------
+
+  // リセット (A/X/Y/SP は保持)
+  template <class Bus>
+  inline void Reset(State& cpu, Bus& bus)
+  {
+    cpu.irq    = false;
+    cpu.nmi    = false;
+    cpu.pc     = Read16(bus, RESET_VEC);
+    cpu.step   = 0;
+    cpu.wai    = false;
+    cpu.stp    = false;
+    cpu.opcode = 0;
+    cpu.p      = (cpu.p & ~FLAG_D) | FLAG_I | FLAG_U | FLAG_B;
+  }
+
+  // 命令1つ分 (または割り込み受付) を実行し、消費サイクル数を返す
+  template <class Bus>
+  inline uint8_t InstCycle(State& cpu, Bus& bus)
+  {
+    if (cpu.stp)
+    {
+      uint8_t ticks = cpu.step + 1;
+      cpu.step = 0;
+      return ticks;
+    }
+    if (cpu.step)
+    {
+      uint8_t ticks = cpu.step;
+      cpu.step = 0;
+      return ticks;
+    }
+    return Step(cpu, bus);
+  }
+
+  // WAI 中で割り込み要求がなければ、待機サイクルを停止条件 (now >= target または
+  // now > next_due) に達するまでまとめて進める。1サイクルずつ InstCycle を呼ぶのと結果は同じ。
+  // 進めたら true (割り込み要求・NMI・STP・Tick 途中では何もせず false)
+  inline bool SkipWait(State& cpu, uint64_t& now, uint64_t target, uint64_t next_due)
+  {
+    if (!cpu.wai || cpu.irq || cpu.nmi || cpu.stp || cpu.step) return false;
+    uint64_t until = next_due < target ? next_due + 1 : target;
+    now = until > now ? until : now + 1;
+    return true;
+  }
+
+  // ---------------------------------------------------------------
+  //  待機ループの検出
+  //
+  //  後方分岐で戻ってきたループ先頭で、レジスタ (A/X/Y/P/SP) が前回戻ってきたときと同じで、
+  //  ループ本体が「書き込みなし・読み出しは PureRead なアドレスだけ」の命令でできていれば、
+  //  次のイベントまで同じ周期を繰り返すだけなので、周期の整数倍だけ now を進める。
+  //  レジスタ・フラグ・各命令の開始サイクルの位相は1命令ずつ実行した場合と同じになる。
+  // ---------------------------------------------------------------
+
+  // 後方分岐・JMP $xxxx (検出対象の命令)
+  constexpr bool IsLoopBranch(int opc)
+  {
+    return OPCODES[opc].mode == REL || OPCODES[opc].op == BBR || OPCODES[opc].op == BBS ||
+           (OPCODES[opc].op == JMP && OPCODES[opc].mode == AB);
+  }
+
+  // 検出の状態 (Run の呼び出しごと・割り込み受付ごとに作り直す)
+  struct IdleLoop
+  {
+    static constexpr uint32_t NONE = 0x10000;
+
+    uint32_t head   = NONE; // そのときのループ先頭
+    uint32_t branch = NONE; // そのときの分岐命令のアドレス
+    uint64_t regs   = 0;    // そのときの A/X/Y/P/SP
+    uint64_t at     = 0;    // そのときのサイクル
+    uint32_t bad    = NONE; // 待機ループでないと判定した分岐命令のアドレス
+  };
+
+  // [head, branch] の命令がすべて待機ループに使えるか
+  template <class Bus>
+  inline bool IsIdleBody(Bus& bus, uint16_t head, uint16_t branch)
+  {
+    static constexpr int MAX_BYTES = 64;
+    if (branch < head || branch - head >= MAX_BYTES) return false;
+
+    uint64_t starts = 0;  // 命令の先頭オフセット
+    uint64_t targets = 0; // 分岐先オフセット
+    uint32_t addr = head;
+    while (addr <= branch)
+    {
+      if (!bus.PureRead(addr)) return false;
+      uint8_t opc = bus.Read(addr);
+      Op   op   = OPCODES[opc].op;
+      Mode mode = OPCODES[opc].mode;
+      int  len  = (op == BBR || op == BBS) ? 3 :
+                  (mode == IMP || mode == ACC) ? 1 :
+                  (mode >= AB && mode <= INDX) ? 3 : 2;
+      if (addr + len - 1 > 0xFFFF || !bus.PureRead(addr + len - 1)) return false;
+      starts |= 1ull << (addr - head);
+
+      switch (op)
+      {
+        // 書き込み・スタック・割り込みマスクの変更・制御の移動はループにしない
+        case STA: case STX: case STY: case STZ: case TSB: case TRB: case RMB: case SMB:
+        case PHA: case PHP: case PHX: case PHY: case PLA: case PLP: case PLX: case PLY:
+        case JSR: case RTS: case RTI: case BRK: case WAI: case STP: case CLI: case SEI:
+          return false;
+        // メモリへの読み書き命令はアキュムレータ版だけ
+        case ASL: case LSR: case ROL: case ROR: case INC: case DEC:
+          if (mode != ACC) return false;
+          break;
+        case JMP:
+          if (mode != AB) return false;
+          break;
+        default:
+          break;
+      }
+
+      // オペランド
+      uint16_t operand = bus.Read(addr + 1) | (len == 3 ? bus.Read(addr + 2) << 8 : 0);
+      switch (mode)
+      {
+        case IMP: case ACC: case IMM: case ZP: case ZPX: case ZPY:
+          break;
+        case AB:
+          if (op != JMP && !bus.PureRead(operand)) return false;
+          break;
+        case REL:
+          break;
+        default:
+          // 間接・インデックス付き絶対は読み出し先が一定でないので対象外
+          return false;
+      }
+
+      // ループ内への分岐先は命令先頭に限る (ループ外へは抜けるだけなのでよい)
+      int32_t target = -1;
+      if (mode == REL)             target = addr + 2 + (int8_t)operand;
+      else if (op == BBR || op == BBS) target = addr + 3 + (int8_t)(operand >> 8);
+      else if (op == JMP)          target = operand;
+      if (target >= head && target <= branch) targets |= 1ull << (target - head);
+      addr += len;
+    }
+    return ((starts >> (branch - head)) & 1) && (targets & ~starts) == 0;
+  }
+
+  // 遅延ループ ([NOP ...] DEX/DEY/INX/INY, BNE 先頭) を、BNE で先頭へ戻った時点から閉じた式で進める。
+  // カウンタが 0 になる直前の反復までを、停止条件を越えない範囲でまとめて実行したことにする
+  // (抜ける反復はインタプリタが実行する)。多重ループでは内側のループが外側の1反復ごとに縮む。
+  // 進めたら true
+  template <class Bus>
+  inline bool SkipDelayLoop(State& cpu, Bus& bus, uint64_t& now, uint64_t target, uint64_t next_due)
+  {
+    static constexpr int MAX_BYTES = 16;
+    uint16_t head   = cpu.pc;
+    uint16_t branch = cpu.opcode_addr;
+    if (cpu.opcode != 0xD0 || branch == head || branch - head > MAX_BYTES) return false;
+    if (!bus.PureRead(head) || !bus.PureRead(branch)) return false;
+
+    // BNE の直前がカウンタ命令
+    uint8_t* reg;
+    int      step;
+    switch (bus.Read(branch - 1))
+    {
+      case 0xCA: reg = &cpu.x; step = -1; break; // DEX
+      case 0x88: reg = &cpu.y; step = -1; break; // DEY
+      case 0xE8: reg = &cpu.x; step = +1; break; // INX
+      case 0xC8: reg = &cpu.y; step = +1; break; // INY
+      default:   return false;
+    }
+    // それより前は NOP だけ。1反復のサイクル数 (BNE 成立・ページ跨ぎを含む)
+    uint32_t period = 2 + 3 + ((((branch + 2) ^ head) & 0xFF00) != 0);
+    for (uint16_t addr = head; addr != branch - 1; addr++)
+    {
+      const Opcode& o = OPCODES[bus.Read(addr)];
+      if (o.op != NOP || o.mode != IMP) return false;
+      period += o.cycles;
+    }
+
+    if ((cpu.step | cpu.stp | cpu.wai | cpu.nmi) || (cpu.irq && !(cpu.p & FLAG_I))) return false;
+    if (now >= target || now > next_due) return false;
+    // カウンタが 0 になるまでの反復数。分岐や JMP で直接 BNE へ来たときはカウンタが 0 でも
+    // Z が立っていないことがあり、その場合 DEX/DEY は 256 回で 0 に戻る
+    uint32_t left  = step < 0 ? (*reg ? *reg : 256) : 256 - *reg;
+    uint64_t limit = next_due < target - 1 ? next_due : target - 1;
+    uint64_t n     = (limit - now) / period;
+    if (n > left - 1) n = left - 1;
+    if (n == 0) return false;
+
+    *reg = (uint8_t)(*reg + step * (int)n);
+    SetNZ(cpu, *reg);
+    now += n * period;
+    cpu.delay_skipped += n * period;
+    return true;
+  }
+
+  // 後方分岐・JMP の直後に呼ぶ。待機ループなら停止条件の手前まで周期単位で now を進める
+  template <class Bus>
+  inline void OnLoopBranch(IdleLoop& loop, State& cpu, Bus& bus,
+                           uint64_t& now, uint64_t target, uint64_t next_due)
+  {
+    // 前方へ進んだ。ループの外へ出たら、出た先で何をしたか分からないので検出をやり直す
+    if (cpu.pc > cpu.opcode_addr)
+    {
+      if (cpu.pc > loop.branch || cpu.pc < loop.head) loop.branch = IdleLoop::NONE;
+      return;
+    }
+    if (SkipDelayLoop(cpu, bus, now, target, next_due)) return;
+    uint64_t regs = cpu.a | cpu.x << 8 | cpu.y << 16 | (uint32_t)cpu.p << 24 | (uint64_t)cpu.sp << 32;
+    if (loop.branch != cpu.opcode_addr || loop.head != cpu.pc || loop.regs != regs)
+    {
+      loop.head   = cpu.pc;
+      loop.branch = cpu.opcode_addr;
+      loop.regs   = regs;
+      loop.at     = now;
+      return;
+    }
+    if (cpu.opcode_addr == loop.bad) return;
+    if ((cpu.step | cpu.stp | cpu.wai | cpu.nmi) || (cpu.irq && !(cpu.p & FLAG_I))) return;
+
+    // 前回と同じ状態で戻ってきた: 本体を確かめて周期ごと飛ばす
+    uint64_t period = now - loop.at;
+    loop.at = now;
+    if (!IsIdleBody(bus, cpu.pc, cpu.opcode_addr))
+    {
+      loop.bad = cpu.opcode_addr;
+      return;
+    }
+    if (period == 0 || now >= target || now > next_due) return;
+    uint64_t limit = next_due < target - 1 ? next_due : target - 1;
+    uint64_t skip  = (limit - now) / period * period;
+    now += skip;
+    loop.at = now;
+    cpu.idle_skipped += skip;
+  }
+
+  // 1サイクル実行
+  template <class Bus>
+  inline void Tick(State& cpu, Bus& bus)
+  {
+    if (cpu.stp) return;
+    if (cpu.step) { --cpu.step; return; }
+    cpu.step = Step(cpu, bus) - 1;
+  }
+
+  // 命令を連続実行する
+  // 少なくとも1命令実行し、now >= target または now > next_due になるか STP で止まったら戻る。
+  // pc_limit を渡すと、命令境界で pc >= pc_limit になったときも戻る (ROM の AOT コードへ渡す用)。
+  // now は各命令の開始サイクルを保ったまま進めるので、I/O ハンドラからも参照できる。
+  // next_due は I/O アクセスで変わりうるので参照で受けて毎命令読み直す。
+  //
+  // FXT_W65C02_THREADED=1 (GCC/Clang の既定) では labels-as-values による
+  // direct-threaded dispatch を使う。各命令ハンドラの末尾に次命令のフェッチと
+  // 間接ジャンプを複製するため、分岐予測が命令の並びごとに効く。
+  // 割り込み・WAI・STP・Tick の途中状態は InstCycle (switch 分岐) で処理する。
+  // WAI で割り込みを待つ間は、停止条件までのサイクルを SkipWait で一度に進める。
+  // 後方分岐のたびに OnLoopBranch で待機ループ・遅延ループを調べ、見つかれば同様にまとめて進める。
+  template <class Bus>
+  inline void Run(State& cpu, Bus& bus, uint64_t& now, uint64_t target, const uint64_t& next_due,
+                  uint32_t pc_limit = 0x10000)
+  {
+    IdleLoop loop;
+#if FXT_W65C02_THREADED
+#define FXT_W65C02_LABEL(n) &&op_##n,
+    static void* const HANDLERS[256] = { FXT_W65C02_ALL(FXT_W65C02_LABEL) };
+#undef FXT_W65C02_LABEL
+
+    // 次の命令へ (通常経路ならフェッチしてハンドラへ直接ジャンプ)
+#define FXT_W65C02_NEXT()                                       \
+    do {                                                        \
+      if (now >= target || now > next_due) return;              \
+      if (cpu.pc >= pc_limit) return;                           \
+      if ((cpu.step | cpu.stp | cpu.wai | cpu.nmi) ||           \
+          (cpu.irq && !(cpu.p & FLAG_I)))                       \
+        goto slow;                                              \
+      cpu.opcode_addr = cpu.pc++;                               \
+      cpu.opcode      = bus.Fetch(cpu.opcode_addr);             \
+      goto *HANDLERS[cpu.opcode];                               \
+    } while (0)
+
+    // 1命令目は停止条件を見ずに実行
+    if (!(cpu.step | cpu.stp | cpu.wai | cpu.nmi) && !(cpu.irq && !(cpu.p & FLAG_I)))
+    {
+      cpu.opcode_addr = cpu.pc++;
+      cpu.opcode      = bus.Fetch(cpu.opcode_addr);
+      goto *HANDLERS[cpu.opcode];
+    }
+
+  slow:
+    loop = IdleLoop();
+    if (!SkipWait(cpu, now, target, next_due)) now += InstCycle(cpu, bus);
+    if (cpu.stp) return;
+    FXT_W65C02_NEXT();
+
+#define FXT_W65C02_HANDLER(n)                                   \
+  op_##n:                                                       \
+    now += Execute<Bus, n>(cpu, bus);                           \
+    if (OPCODES[n].op == STP) return;                           \
+    if (IsLoopBranch(n))                                        \
+      OnLoopBranch(loop, cpu, bus, now, target, next_due);      \
+    FXT_W65C02_NEXT();
+    FXT_W65C02_ALL(FXT_W65C02_HANDLER)
+#undef FXT_W65C02_HANDLER
+#undef FXT_W65C02_NEXT
+#else
+    do
+    {
+      if ((cpu.step | cpu.stp | cpu.wai | cpu.nmi) || (cpu.irq && !(cpu.p & FLAG_I)))
+      {
+        loop = IdleLoop();
+        if (!SkipWait(cpu, now, target, next_due)) now += InstCycle(cpu, bus);
+        continue;
+      }
+      cpu.opcode_addr = cpu.pc++;
+      cpu.opcode      = bus.Fetch(cpu.opcode_addr);
+      now += Dispatch(cpu, bus, cpu.opcode);
+      if (IsLoopBranch(cpu.opcode)) OnLoopBranch(loop, cpu, bus, now, target, next_due);
+    }
+    while (!cpu.stp && now < target && now <= next_due && cpu.pc < pc_limit);
+#endif
+  }
+
+}
+}
+
+#undef FXT_W65C02_ALL
+#undef FXT_W65C02_ROW
@@ -0,0 +1,358 @@
+/* src/bench/microbench.cpp - 周辺機器・CPU のホットパス単体ベンチマーク (外部依存なし)
+ *
+ * libfxt65core の各部品を直接呼び、1操作あたりの時間を計る。
+ * ケースごとにウォームアップの後、繰り返し (rep) ごとに「1操作あたりの時間」を測り、
+ * その min / median / p99 を表と JSON で出す。1操作の大きさ (items) も併記する。
+ *
+ *   ./fxt65-microbench [key=value ...]
+ *     filter=STR   名前に STR を含むケースだけ実行
+ *     reps=N       繰り返し回数 (既定 50)
+ *     warmup=N     ウォームアップの回数 (既定 5)
+ *     json=PATH    結果を JSON で書き出す
+ *     sd=PATH      SD ケースの作業用イメージ (既定 一時ディレクトリに作って消す)
+ */
+
+#include "../FxtSystem.hpp"
+#include "../Cpu.hpp"
+#include "../Chdz.hpp"
+#include "../Sd.hpp"
+#include "../Psg.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------
+//  ベンチマーク本体
+// ---------------------------------------------------------------
+struct Case
+{
+  const char* name;
+  const char* item;      // 1操作の中身の単位 (pixel, byte, sample, cycle)
+  double      items;     // 1操作あたりの items
+  int         ops;       // 1回の計測で実行する操作の数
+  void (*setup)();
+  uint32_t (*op)();      // 1操作。結果は最適化で消されないよう集計する
+};
+
+struct Result
+{
+  const Case* c;
+  double min_ns, median_ns, p99_ns; // 1操作あたり
+};
+
+static volatile uint32_t g_sink; // 結果の捨て先
+
+static Result Measure(const Case& c, int reps, int warmup)
+{
+  typedef std::chrono::steady_clock Clock;
+  if (c.setup) c.setup();
+
+  uint32_t acc = 0;
+  for (int i = 0; i < warmup * c.ops; i++) acc += c.op();
+
+  std::vector<double> ns(reps);
+  for (int r = 0; r < reps; r++)
+  {
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < c.ops; i++) acc += c.op();
+    ns[r] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / c.ops;
+  }
+  g_sink = acc;
+
+  std::sort(ns.begin(), ns.end());
+  Result res;
+  res.c         = &c;
+  res.min_ns    = ns.front();
+  res.median_ns = ns[ns.size() / 2];
+  res.p99_ns    = ns[std::min(ns.size() - 1, (size_t)(ns.size() * 0.99))];
+  return res;
+}
+
+// ---------------------------------------------------------------
+//  Chdz
+// ---------------------------------------------------------------
+static Chdz::State g_chdz;
+static uint32_t    g_pixels[Chdz::DISPLAY_W * Chdz::DISPLAY_H];
+static constexpr int CHDZ_BURST = 4096; // 1操作の書き込み数
+
+static void ChdzFill(bool ttmode)
+{
+  g_chdz = Chdz::State();
+  uint32_t x = 0x12345678;
+  for (auto& frame : g_chdz.vram)
+    for (auto& b : frame) { x = x * 1103515245u + 12345u; b = (uint8_t)(x >> 24); }
+  for (auto& tt : g_chdz.frame_ttmode) tt = ttmode;
+  g_chdz.tt_color_0 = 0x0;
+  g_chdz.tt_color_1 = 0xF;
+  Chdz::Write(g_chdz, 0xE605, 0x1B); // サブ行ごとに別フレーム
+}
+
+static void SetupRender16() { ChdzFill(false); }
+static void SetupRender2()  { ChdzFill(true); }
+
+static uint32_t OpRender()
+{
+  Chdz::RenderFrame(g_chdz, g_pixels);
+  return g_pixels[1234];
+}
+
+// charbox: 幅4バイト × 高さ8行の文字を敷き詰める
+static void SetupWriteCharbox()
+{
+  g_chdz = Chdz::State();
+  Chdz::Write(g_chdz, 0xE606, 0x03);
+  Chdz::Write(g_chdz, 0xE607, 0x07);
+}
+
+static void SetupWritePlain()
+{
+  g_chdz = Chdz::State();
+  Chdz::Write(g_chdz, 0xE606, 0x80);
+}
+
+static uint32_t OpWriteWdat()
+{
+  Chdz::Write(g_chdz, 0xE602, 0);
+  Chdz::Write(g_chdz, 0xE603, 0);
+  for (int i = 0; i < CHDZ_BURST; i++) Chdz::Write(g_chdz, 0xE604, (uint8_t)i);
+  return g_chdz.cursor;
+}
+
+static uint32_t OpWriteRept()
+{
+  Chdz::Write(g_chdz, 0xE602, 0);
+  Chdz::Write(g_chdz, 0xE603, 0);
+  Chdz::Write(g_chdz, 0xE604, 0x5A);
+  for (int i = 1; i < CHDZ_BURST; i++) Chdz::Write(g_chdz, 0xE601, 0);
+  return g_chdz.cursor;
+}
+
+// ---------------------------------------------------------------
+//  Sd (SPI 1バイト転送の列で CMD17 / CMD24 を1回分)
+// ---------------------------------------------------------------
+static Fxt::System* g_sd_sys  = nullptr;
+static std::string  g_sd_path;
+static bool         g_sd_temp = false; // 作業用イメージを自分で作ったか
+static constexpr uint32_t SD_SECTORS = 2048;
+
+static void SdCommand(uint8_t cmd, uint32_t arg)
+{
+  Fxt::System& sys = *g_sd_sys;
+  Fxt::Sd::Transfer(sys, 0x40 | cmd);
+  Fxt::Sd::Transfer(sys, (uint8_t)(arg >> 24));
+  Fxt::Sd::Transfer(sys, (uint8_t)(arg >> 16));
+  Fxt::Sd::Transfer(sys, (uint8_t)(arg >> 8));
+  Fxt::Sd::Transfer(sys, (uint8_t)arg);
+  Fxt::Sd::Transfer(sys, 0x01);
+  while (Fxt::Sd::Transfer(sys, 0xFF) == 0xFF) {} // R1
+}
+
+static void SetupSd()
+{
+  if (g_sd_sys) return;
+  if (g_sd_path.empty())
+  {
+#ifdef _WIN32
+    const char* dir = ".";
+#else
+    const char* dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+#endif
+    g_sd_path = std::string(dir) + "/fxt65-microbench-sd.img";
+    g_sd_temp = true;
+    FILE* fp = fopen(g_sd_path.c_str(), "wb");
+    if (!fp) { fprintf(stderr, "Error: 作業用イメージを作れません (%s)\n", g_sd_path.c_str()); exit(1); }
+    static uint8_t sector[512];
+    for (uint32_t i = 0; i < SD_SECTORS; i++)
+    {
+      memset(sector, (int)(i & 0xFF), sizeof(sector));
+      fwrite(sector, 1, sizeof(sector), fp);
+    }
+    fclose(fp);
+  }
+  g_sd_sys = new Fxt::System();
+  if (!Fxt::Sd::MountImg(*g_sd_sys, g_sd_path)) exit(1);
+  Fxt::Sd::SetCs(*g_sd_sys, true);
+}
+
+static uint32_t g_sd_lba = 0;
+
+static uint32_t OpSdRead()
+{
+  Fxt::System& sys = *g_sd_sys;
+  g_sd_lba = (g_sd_lba + 7) % sys.sd.total_sectors;
+  SdCommand(17, g_sd_lba);
+  while (Fxt::Sd::Transfer(sys, 0xFF) != 0xFE) {} // データトークン
+  uint32_t sum = 0;
+  for (int i = 0; i < 512; i++) sum += Fxt::Sd::Transfer(sys, 0xFF);
+  return sum;
+}
+
+static uint32_t OpSdWrite()
+{
+  Fxt::System& sys = *g_sd_sys;
+  g_sd_lba = (g_sd_lba + 7) % sys.sd.total_sectors;
+  SdCommand(24, g_sd_lba);
+  Fxt::Sd::Transfer(sys, 0xFE); // スタートトークン
+  for (int i = 0; i < 512; i++) Fxt::Sd::Transfer(sys, (uint8_t)(g_sd_lba + i));
+  uint8_t r;
+  while ((r = Fxt::Sd::Transfer(sys, 0xFF)) == 0xFF) {} // データレスポンス
+  return r;
+}
+
+// ---------------------------------------------------------------
+//  PSG (emu2149)
+// ---------------------------------------------------------------
+static Psg::State g_psg;
+static constexpr int PSG_BLOCK = 1024; // 1操作のサンプル数
+
+static void SetupPsg(int quality)
+{
+  Psg::Init(g_psg, 44100);
+  PSG_setQuality(g_psg.psg, (uint8_t)quality);
+  // 3音 + ノイズ + エンベロープを鳴らす
+  static const uint8_t regs[14] = {0x1C, 0x01, 0x8E, 0x00, 0x3F, 0x02, 0x10, 0x30,
+                                   0x0F, 0x10, 0x0C, 0x00, 0x10, 0x0E};
+  for (int i = 0; i < 14; i++)
+  {
+    Psg::WriteAddr(g_psg, (uint8_t)i);
+    Psg::WriteData(g_psg, regs[i]);
+  }
+}
+
+static void SetupPsgQ0() { SetupPsg(0); }
+static void SetupPsgQ1() { SetupPsg(1); }
+
+static uint32_t OpPsg()
+{
+  uint32_t acc = 0;
+  for (int i = 0; i < PSG_BLOCK; i++) acc += (uint16_t)Psg::Calc(g_psg);
+  return acc;
+}
+
+// ---------------------------------------------------------------
+//  CPU (ROM 上の演算ループを RunCycles で回す)
+// ---------------------------------------------------------------
+static Fxt::System* g_cpu_sys = nullptr;
+static constexpr uint64_t CPU_BLOCK = 1000000; // 1操作のサイクル数
+
+static void SetupCpu()
+{
+  if (g_cpu_sys) return;
+  g_cpu_sys = new Fxt::System();
+  Fxt::System& sys = *g_cpu_sys;
+  // $F000: ページ $02 を加算しながら書き換え、ゼロページのカウンタを進めるループ
+  static const uint8_t prog[] = {
+    0xA2, 0x00,             // F000 LDX #$00
+    0xBD, 0x00, 0x02,       // F002 LDA $0200,X
+    0x18,                   // F005 CLC
+    0x69, 0x03,             // F006 ADC #$03
+    0x9D, 0x00, 0x02,       // F008 STA $0200,X
+    0x45, 0x10,             // F00B EOR $10
+    0x85, 0x10,             // F00D STA $10
+    0xE8,                   // F00F INX
+    0xD0, 0xF0,             // F010 BNE $F002
+    0xE6, 0x11,             // F012 INC $11
+    0x4C, 0x00, 0xF0,       // F014 JMP $F000
+  };
+  memcpy(sys.rom, prog, sizeof(prog));
+  sys.rom[0xFFC] = 0x00; sys.rom[0xFFD] = 0xF0; // RESET
+  sys.rom[0xFFE] = 0x00; sys.rom[0xFFF] = 0xF0; // IRQ (使わない)
+  sys.rom[0xFFA] = 0x00; sys.rom[0xFFB] = 0xF0; // NMI (使わない)
+  sys.cfg.audio_hz = 0;
+  sys.cfg.rom_aot  = false; // 生成元の ROM と違うので使わないが、照合も省く
+  Fxt::Init(sys);
+}
+
+static uint32_t OpCpu()
+{
+  Fxt::RunCycles(*g_cpu_sys, CPU_BLOCK);
+  return g_cpu_sys->ram[0x11];
+}
+
+// ---------------------------------------------------------------
+//  ケース一覧
+// ---------------------------------------------------------------
+static const Case CASES[] = {
+  {"chdz.render.16color",     "pixel",   Chdz::DISPLAY_W * Chdz::DISPLAY_H, 10, SetupRender16,     OpRender},
+  {"chdz.render.2color",      "pixel",   Chdz::DISPLAY_W * Chdz::DISPLAY_H, 10, SetupRender2,      OpRender},
+  {"chdz.write.wdat",         "byte",    CHDZ_BURST,                        50, SetupWritePlain,   OpWriteWdat},
+  {"chdz.write.rept",         "byte",    CHDZ_BURST,                        50, SetupWritePlain,   OpWriteRept},
+  {"chdz.write.wdat.charbox", "byte",    CHDZ_BURST,                        50, SetupWriteCharbox, OpWriteWdat},
+  {"chdz.write.rept.charbox", "byte",    CHDZ_BURST,                        50, SetupWriteCharbox, OpWriteRept},
+  {"sd.cmd17.read",           "byte",    512,                               50, SetupSd,           OpSdRead},
+  {"sd.cmd24.write",          "byte",    512,                               20, SetupSd,           OpSdWrite},
+  {"psg.calc.quality0",       "sample",  PSG_BLOCK,                         20, SetupPsgQ0,        OpPsg},
+  {"psg.calc.quality1",       "sample",  PSG_BLOCK,                         20, SetupPsgQ1,        OpPsg},
+  {"cpu.run",                 "cycle",   (double)CPU_BLOCK,                  2, SetupCpu,          OpCpu},
+};
+
+// ---------------------------------------------------------------
+//  main
+// ---------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const char* filter    = "";
+  const char* json_path = nullptr;
+  int reps   = 50;
+  int warmup = 5;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char* eq = strchr(argv[i], '=');
+    std::string key = eq ? std::string(argv[i], eq - argv[i]) : std::string(argv[i]);
+    const char* val = eq ? eq + 1 : "";
+    if      (key == "filter") filter    = val;
+    else if (key == "reps")   reps      = std::max(1, atoi(val));
+    else if (key == "warmup") warmup    = std::max(0, atoi(val));
+    else if (key == "json")   json_path = val;
+    else if (key == "sd")     g_sd_path = val;
+    else
+    {
+      fprintf(stderr, "Error: 不明な引数: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  std::vector<Result> results;
+  printf("%-26s %12s %12s %12s %14s\n", "case", "min [ns]", "median [ns]", "p99 [ns]", "median/item");
+  for (const Case& c : CASES)
+  {
+    if (!strstr(c.name, filter)) continue;
+    Result r = Measure(c, reps, warmup);
+    results.push_back(r);
+    printf("%-26s %12.0f %12.0f %12.0f %9.3f ns/%s\n",
+           c.name, r.min_ns, r.median_ns, r.p99_ns, r.median_ns / c.items, c.item);
+    fflush(stdout);
+  }
+
+  delete g_sd_sys;
+  delete g_cpu_sys;
+  if (g_sd_temp) remove(g_sd_path.c_str());
+
+  if (json_path)
+  {
+    FILE* fp = fopen(json_path, "w");
+    if (!fp)
+    {
+      fprintf(stderr, "Error: JSON を書き出せません (%s)\n", json_path);
+      return 1;
+    }
+    fprintf(fp, "{\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"cases\": [\n", reps, warmup);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+      const Result& r = results[i];
+      fprintf(fp, "    {\"name\": \"%s\", \"item\": \"%s\", \"items_per_op\": %.0f, "
+                  "\"min_ns\": %.1f, \"median_ns\": %.1f, \"p99_ns\": %.1f}%s\n",
+              r.c->name, r.c->item, r.c->items, r.min_ns, r.median_ns, r.p99_ns,
+              i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+  }
+  return 0;
+}
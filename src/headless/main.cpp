@@ -0,0 +1,532 @@
+/* src/headless/main.cpp - FxT-65 エミュレータ ヘッドレス実行 (sokol / ImGui なし)
+ *
+ * 画面・音声なしで libfxt65core を実行する。フレームレートで待たず、ホストの上限速度で回す。
+ * UART 出力は標準出力へ、このプログラム自身のメッセージは標準エラーへ出す。
+ *
+ *   ./fxt65-headless [key=value ...]
+ *     rom=PATH       ROM イメージ (既定 assets/rom.bin)
+ *     sd=PATH        SD カードイメージ (既定 sdcard.vhd → sdcard.img の順で試行)
+ *     cmd=STR        起動後に UART へ送る文字列 (\n \r \t \\ を解釈)
+ *     cmd_delay=N    UART 入力を始めるまでの待機 [フレーム] (既定 30、GUI 版と同じ)
+ *     input=PATH     cmd の後に UART へ送るファイル (- で標準入力)
+ *     cycles=N       N サイクル実行したら終了 (既定 0 = 無制限。STP でも終了)
+ *     until=STR      UART 入力をすべて送った後、UART 出力に STR が現れたら終了
+ *     json=PATH      終了時に実行時間・サイクル数・ピークメモリを JSON で書き出す (make bench 用)
+ *                    SD カードイメージの SHA-256 も記録する
+ *     sd_sha256=HEX  SD カードイメージの SHA-256 がこれと一致しなければ実行しない (make bench 用)
+ *     dump=PATH      終了時にフレームバッファを PPM (256×768) で書き出す
+ *                    (POSIX では SIGUSR1 を受けたときにも書き出す)
+ *     cpu_hz=N  jit=0  aot=0  trace=1   GUI 版と同じ
+ *     hotspot=BASE   PC ごとのサイクル・命令数を計測し、終了時に BASE.csv / BASE.json へ書き出す
+ *     sym=PATHS      シンボルファイル (cc65 .dbg / .map / VICE ラベル、カンマ区切りで複数)
+ *                    省略時は ROM と同じ名前の .dbg / .map / .lbl があれば読む
+ *     prof=PATH  prof_hz=N                GUI 版と同じ (PROF=1 ビルドのみ)
+ *     opstats=BASE  opstats_sample=N      GUI 版と同じ (OPSTATS=1 ビルドのみ)
+ */
+
+#include "../FxtSystem.hpp"
+#include "../Chdz.hpp"
+#include "../Prof.hpp"
+#include "../OpStats.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if !defined(_WIN32)
+#define FXT_HAS_POSIX 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+// ---------------------------------------------------------------
+//  定数
+// ---------------------------------------------------------------
+// RunCycles 1回の実行サイクル数 (UART 入力はこの間隔で受信バッファの空きを見る)
+static constexpr uint64_t SLICE_CYCLES = 4096;
+
+// ---------------------------------------------------------------
+//  グローバル状態
+// ---------------------------------------------------------------
+static Fxt::System g_sys;
+static volatile sig_atomic_t g_quit     = 0; // SIGINT / SIGTERM
+static volatile sig_atomic_t g_dump_req = 0; // SIGUSR1
+
+static void on_quit(int) { g_quit = 1; }
+#ifdef FXT_HAS_POSIX
+static void on_dump(int) { g_dump_req = 1; }
+#endif
+
+// ---------------------------------------------------------------
+//  UART 入力元: cmd 文字列 → input ファイル (標準入力ならノンブロッキング)
+// ---------------------------------------------------------------
+struct UartSource
+{
+  std::string cmd;
+  size_t      cmd_pos  = 0;
+  FILE*       fp       = nullptr;
+  bool        is_stdin = false;
+#ifdef FXT_HAS_POSIX
+  int         oldf     = -1;   // 標準入力の元のフラグ
+#endif
+
+  // 次の1文字 (今は無ければ -1)
+  int Next()
+  {
+    if (cmd_pos < cmd.size()) return (unsigned char)cmd[cmd_pos++];
+    if (!fp) return -1;
+    int ch = fgetc(fp);
+    if (ch != EOF) return ch;
+    if (feof(fp))
+    {
+      if (!is_stdin) fclose(fp);
+      fp = nullptr;
+    }
+    else
+    {
+      clearerr(fp); // EAGAIN: 次のスライスで再試行
+    }
+    return -1;
+  }
+
+  // もう送るものが無い (標準入力は EOF まで)
+  bool Done() const { return cmd_pos >= cmd.size() && !fp; }
+
+  bool Open(const char* path)
+  {
+    if (strcmp(path, "-") == 0)
+    {
+      fp       = stdin;
+      is_stdin = true;
+#ifdef FXT_HAS_POSIX
+      oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
+      fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
+#endif
+      return true;
+    }
+    fp = fopen(path, "rb");
+    return fp != nullptr;
+  }
+
+  ~UartSource()
+  {
+    if (fp && !is_stdin) fclose(fp);
+#ifdef FXT_HAS_POSIX
+    if (oldf >= 0) fcntl(STDIN_FILENO, F_SETFL, oldf);
+#endif
+  }
+};
+
+// ---------------------------------------------------------------
+//  UART 出力: 標準出力へ書き、until の文字列を探す
+// ---------------------------------------------------------------
+struct UartSink
+{
+  std::string until;        // 探す文字列 (空なら探さない)
+  std::string tail;         // 直近の出力 (until の長さ分)
+  bool        armed = false; // 入力をすべて送り終えたら true
+  bool        found = false;
+
+  static void Tx(Fxt::System&, void* ctx, uint8_t ch)
+  {
+    UartSink& sink = *static_cast<UartSink*>(ctx);
+    putchar(ch);
+    if (sink.until.empty()) return;
+    sink.tail += (char)ch;
+    if (sink.tail.size() > sink.until.size()) sink.tail.erase(0, 1);
+    if (sink.armed && sink.tail == sink.until) sink.found = true;
+  }
+};
+
+// cmd 引数のエスケープ (\n \r \t \\) を展開
+static std::string unescape(const char* p)
+{
+  std::string s;
+  for (; *p; p++)
+  {
+    if (*p == '\\' && *(p + 1))
+    {
+      p++;
+      switch (*p)
+      {
+        case 'n':  s += '\n'; break;
+        case 'r':  s += '\r'; break;
+        case 't':  s += '\t'; break;
+        case '\\': s += '\\'; break;
+        default:   s += '\\'; s += *p; break;
+      }
+    }
+    else
+    {
+      s += *p;
+    }
+  }
+  return s;
+}
+
+// ---------------------------------------------------------------
+//  フレームバッファを PPM (P6) で書き出す
+// ---------------------------------------------------------------
+static bool dump_frame(const Fxt::System& sys, const char* path)
+{
+  static uint32_t pixels[Chdz::DISPLAY_W * Chdz::DISPLAY_H];
+  Chdz::RenderFrame(sys.chdz, pixels);
+
+  FILE* fp = fopen(path, "wb");
+  if (!fp) return false;
+  fprintf(fp, "P6\n%d %d\n255\n", Chdz::DISPLAY_W, Chdz::DISPLAY_H);
+  for (uint32_t px : pixels)
+  {
+    // RGBA8888 (R が下位バイト)
+    fputc(px & 0xFF, fp);
+    fputc((px >> 8) & 0xFF, fp);
+    fputc((px >> 16) & 0xFF, fp);
+  }
+  return fclose(fp) == 0;
+}
+
+// ---------------------------------------------------------------
+//  SHA-256 (SD カードイメージの同一性の確認用)
+// ---------------------------------------------------------------
+struct Sha256
+{
+  uint32_t h[8]   = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+  uint8_t  buf[64];
+  size_t   len    = 0; // buf に溜まったバイト数
+  uint64_t total  = 0; // 全体のバイト数
+
+  static uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void Block(const uint8_t* p)
+  {
+    static const uint32_t K[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+      w[i] = (uint32_t)p[i * 4] << 24 | p[i * 4 + 1] << 16 | p[i * 4 + 2] << 8 | p[i * 4 + 3];
+    for (int i = 16; i < 64; i++)
+    {
+      uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++)
+    {
+      uint32_t t1 = k + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+      uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      k = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+  }
+
+  void Update(const uint8_t* p, size_t n)
+  {
+    total += n;
+    while (n)
+    {
+      size_t m = 64 - len < n ? 64 - len : n;
+      memcpy(buf + len, p, m);
+      len += m; p += m; n -= m;
+      if (len == 64) { Block(buf); len = 0; }
+    }
+  }
+
+  // 16進 64 文字
+  std::string Hex()
+  {
+    uint64_t bits = total * 8;
+    uint8_t  pad[72] = { 0x80 };
+    size_t   n = (len < 56 ? 56 : 120) - len;
+    for (int i = 0; i < 8; i++) pad[n + i] = (uint8_t)(bits >> (56 - i * 8));
+    Update(pad, n + 8);
+    char out[65];
+    for (int i = 0; i < 8; i++) snprintf(out + i * 8, 9, "%08x", h[i]);
+    return out;
+  }
+};
+
+// ファイル全体の SHA-256 (読めなければ空文字列)
+static std::string sha256_file(const char* path)
+{
+  FILE* fp = fopen(path, "rb");
+  if (!fp) return "";
+  Sha256 sha;
+  static uint8_t buf[1 << 16];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) sha.Update(buf, n);
+  bool ok = !ferror(fp);
+  fclose(fp);
+  return ok ? sha.Hex() : "";
+}
+
+// JSON 文字列 (パス用に " と \ だけエスケープ)
+static std::string json_str(const char* s)
+{
+  std::string out = "\"";
+  for (; s && *s; s++)
+  {
+    if (*s == '"' || *s == '\\') out += '\\';
+    out += *s;
+  }
+  return out + "\"";
+}
+
+// ピーク RSS [KiB] (取れなければ -1)
+static long peak_rss_kib()
+{
+#ifdef FXT_HAS_POSIX
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+  return (long)(ru.ru_maxrss / 1024); // macOS はバイト単位
+#else
+  return (long)ru.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+// ---------------------------------------------------------------
+//  main
+// ---------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const char* rom_path   = "assets/rom.bin";
+  const char* sd_path    = nullptr;
+  const char* input_path = nullptr;
+  const char* dump_path  = nullptr;
+  const char* json_path  = nullptr;
+  const char* sd_sha256  = nullptr;
+  const char* prof_path  = nullptr;
+  const char* hotspot    = nullptr;
+  const char* sym_paths  = nullptr;
+  int         prof_hz    = 1000;
+  const char* opstats    = nullptr;
+  int         opstats_sample = 16;
+  uint64_t    max_cycles = 0;
+  int         cmd_delay  = 30;
+  UartSource  uart;
+  UartSink    sink;
+
+  // 引数 key=value
+  for (int i = 1; i < argc; i++)
+  {
+    const char* eq = strchr(argv[i], '=');
+    if (!eq)
+    {
+      fprintf(stderr, "Error: 引数は key=value 形式で指定: %s\n", argv[i]);
+      return 2;
+    }
+    std::string key(argv[i], eq - argv[i]);
+    const char* val = eq + 1;
+
+    if      (key == "rom")       rom_path   = val;
+    else if (key == "sd")        sd_path    = val;
+    else if (key == "cmd")       uart.cmd   = unescape(val);
+    else if (key == "cmd_delay") cmd_delay  = atoi(val);
+    else if (key == "input")     input_path = val;
+    else if (key == "cycles")    max_cycles = strtoull(val, nullptr, 0);
+    else if (key == "dump")      dump_path  = val;
+    else if (key == "until")     sink.until = unescape(val);
+    else if (key == "json")      json_path  = val;
+    else if (key == "sd_sha256") sd_sha256  = val;
+    else if (key == "cpu_hz")    g_sys.cfg.cpu_hz  = atoi(val);
+    else if (key == "jit")       g_sys.cfg.jit     = atoi(val) != 0;
+    else if (key == "aot")       g_sys.cfg.rom_aot = atoi(val) != 0;
+    else if (key == "trace")     g_sys.cfg.trace   = atoi(val) != 0;
+    else if (key == "hotspot")   hotspot    = val;
+    else if (key == "sym")       sym_paths  = val;
+    else if (key == "prof")      prof_path  = val;
+    else if (key == "prof_hz")   prof_hz    = atoi(val);
+    else if (key == "opstats")   opstats    = val;
+    else if (key == "opstats_sample") opstats_sample = atoi(val);
+    else
+    {
+      fprintf(stderr, "Error: 不明な引数: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  // ROM ロード
+  if (!Fxt::LoadRom(g_sys, rom_path))
+  {
+    fprintf(stderr, "Error: ROM読み込みに失敗 (%s)\n", rom_path);
+    return 1;
+  }
+
+  // シンボル (プロファイラの出力用。読めなくても実行は続ける)
+  if (sym_paths) Fxt::Symbols::LoadList(g_sys.symbols, sym_paths);
+  else           Fxt::Symbols::LoadForRom(g_sys.symbols, rom_path);
+
+  // SD カードイメージ (無くても起動はする)
+  if (!sd_path)
+    sd_path = Fxt::Sd::MountImg(g_sys, "sdcard.vhd") ? "sdcard.vhd" : "sdcard.img";
+  bool sd_ok = g_sys.sd.image_fp || Fxt::Sd::MountImg(g_sys, sd_path);
+  if (!sd_ok)
+    fprintf(stderr, "Warning: SDカードイメージを開けません (%s)\n",
+            sd_path);
+
+  // SD カードイメージの SHA-256 (ベンチマークの結果がどのイメージで取ったものか示す)
+  std::string sd_hash;
+  if (sd_ok && (json_path || sd_sha256)) sd_hash = sha256_file(sd_path);
+  std::string expect = sd_sha256 ? sd_sha256 : "";
+  for (char& c : expect) c = (char)tolower((unsigned char)c);
+  if (sd_sha256 && sd_hash != expect)
+  {
+    fprintf(stderr, "Error: SDカードイメージが固定したものと違います (%s)\n"
+                    "  期待: %s\n  実際: %s\n",
+            sd_path, sd_sha256, sd_hash.empty() ? "(読めません)" : sd_hash.c_str());
+    return 1;
+  }
+
+  if (input_path && !uart.Open(input_path))
+  {
+    fprintf(stderr, "Error: 入力ファイルを開けません (%s)\n", input_path);
+    return 1;
+  }
+
+  signal(SIGINT,  on_quit);
+  signal(SIGTERM, on_quit);
+#ifdef FXT_HAS_POSIX
+  signal(SIGUSR1, on_dump);
+#endif
+
+  // UART 出力は1文字ずつフラッシュせず、until の検出も行う
+  g_sys.uart_tx     = UartSink::Tx;
+  g_sys.uart_tx_ctx = &sink;
+
+  // 音声は出さない (cfg.audio_hz = 0 でサンプリングイベントを登録しない)
+  g_sys.cfg.audio_hz = 0;
+#if FXT_PROF
+  if (prof_path) Fxt::Prof::Start(prof_path, prof_hz);
+#else
+  if (prof_path) fprintf(stderr, "Warning: prof= は PROF=1 ビルドのみ有効\n");
+  (void)prof_hz;
+#endif
+  auto t0 = std::chrono::steady_clock::now(); // コールドブートから計る
+  Fxt::Init(g_sys);
+  if (hotspot) Fxt::Hotspot::Start(g_sys);
+#if FXT_OPSTATS
+  if (opstats) Fxt::OpStats::Start(g_sys, opstats_sample);
+#else
+  if (opstats) fprintf(stderr, "Warning: opstats= は OPSTATS=1 ビルドのみ有効\n");
+  (void)opstats_sample;
+#endif
+
+  // UART 入力開始サイクル (cmd_delay フレーム分)
+  const uint64_t input_start = (uint64_t)cmd_delay * g_sys.cfg.ticks_per_frame();
+
+  Fxt::StopReason reason = Fxt::StopReason::BUDGET;
+  while (!g_quit && !sink.found)
+  {
+    uint64_t now = g_sys.sched.now;
+    if (max_cycles && now >= max_cycles) break;
+
+    // 受信バッファが空いていれば次の1文字
+    if (now >= input_start && !(g_sys.uart_status & 0b00001000))
+    {
+      int ch = uart.Next();
+      if (ch >= 0) Fxt::UartInput(g_sys, ch);
+      if (uart.Done()) sink.armed = true; // 最後の1文字への応答から探す
+    }
+
+    uint64_t budget = SLICE_CYCLES;
+    if (max_cycles && max_cycles - now < budget) budget = max_cycles - now;
+    reason = Fxt::RunCycles(g_sys, budget);
+    g_sys.audio_count = 0;
+    if (uart.is_stdin) fflush(stdout); // 対話時はプロンプトをすぐ出す
+
+    if (g_dump_req && dump_path)
+    {
+      g_dump_req = 0;
+      if (!dump_frame(g_sys, dump_path))
+        fprintf(stderr, "Error: フレームバッファを書き出せません (%s)\n", dump_path);
+    }
+    if (reason == Fxt::StopReason::STP) break;
+  }
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+#if FXT_PROF
+  Fxt::Prof::Stop(stderr, &g_sys.symbols);
+#endif
+
+  if (dump_path && !dump_frame(g_sys, dump_path))
+    fprintf(stderr, "Error: フレームバッファを書き出せません (%s)\n", dump_path);
+  if (hotspot) Fxt::Hotspot::Dump(g_sys, hotspot);
+#if FXT_OPSTATS
+  if (opstats) Fxt::OpStats::Dump(g_sys, opstats);
+#endif
+
+  fflush(stdout);
+  const char* stop = sink.found ? "until" :
+                     reason == Fxt::StopReason::STP ? "stp" :
+                     g_quit ? "interrupted" : "cycles";
+  uint64_t cycles = g_sys.sched.now;
+  fprintf(stderr, "%s: %llu cycles in %.3f s (%.2f MHz)\n",
+          stop, (unsigned long long)cycles, sec, sec > 0 ? cycles / sec * 1e-6 : 0.0);
+#if !FXT_CPU_VREMU
+  // トレースキャッシュ使用時は融合命令の統計を出力
+  Fxt::Trace::DumpStats(g_sys, stderr);
+  // 待機ループ・遅延ループの検出で飛ばしたサイクル数
+  if (g_sys.cpu.idle_skipped)
+    fprintf(stderr, "idle loop: %llu / %llu cycles skipped\n",
+            (unsigned long long)g_sys.cpu.idle_skipped, (unsigned long long)cycles);
+  if (g_sys.cpu.delay_skipped)
+    fprintf(stderr, "delay loop: %llu / %llu cycles skipped\n",
+            (unsigned long long)g_sys.cpu.delay_skipped, (unsigned long long)cycles);
+#endif
+
+  if (json_path)
+  {
+    FILE* fp = fopen(json_path, "w");
+    if (!fp)
+    {
+      fprintf(stderr, "Error: JSON を書き出せません (%s)\n", json_path);
+      return 1;
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"stop\": \"%s\",\n", stop);
+    fprintf(fp, "  \"rom\": %s,\n", json_str(rom_path).c_str());
+    fprintf(fp, "  \"sd\": %s,\n", sd_ok ? json_str(sd_path).c_str() : "null");
+    fprintf(fp, "  \"sd_sha256\": %s,\n", sd_hash.empty() ? "null" : json_str(sd_hash.c_str()).c_str());
+#if FXT_CPU_VREMU
+    fprintf(fp, "  \"core\": \"vremu\",\n");
+#else
+    fprintf(fp, "  \"core\": \"native\",\n");
+    fprintf(fp, "  \"trace\": %s,\n", g_sys.trace ? "true" : "false");
+    fprintf(fp, "  \"idle_skipped\": %llu,\n", (unsigned long long)g_sys.cpu.idle_skipped);
+    fprintf(fp, "  \"delay_skipped\": %llu,\n", (unsigned long long)g_sys.cpu.delay_skipped);
+#endif
+#if FXT_JIT
+    fprintf(fp, "  \"jit\": %s,\n", g_sys.jit ? "true" : "false");
+#endif
+#if FXT_ROM_AOT
+    fprintf(fp, "  \"rom_aot\": %s,\n", g_sys.rom_aot ? "true" : "false");
+#endif
+    fprintf(fp, "  \"wall_s\": %.6f,\n", sec);
+    fprintf(fp, "  \"cycles\": %llu,\n", (unsigned long long)cycles);
+    fprintf(fp, "  \"cycles_per_s\": %.0f,\n", sec > 0 ? cycles / sec : 0.0);
+    fprintf(fp, "  \"mhz\": %.3f,\n", sec > 0 ? cycles / sec * 1e-6 : 0.0);
+    fprintf(fp, "  \"ns_per_cycle\": %.4f,\n", cycles ? sec * 1e9 / cycles : 0.0);
+    fprintf(fp, "  \"peak_rss_kib\": %ld\n", peak_rss_kib());
+    fprintf(fp, "}\n");
+    fclose(fp);
+  }
+  return sink.until.empty() || sink.found ? 0 : 3;
+}
@@ -50,6 +50,11 @@ struct vrEmu6502_s
 
   vrEmu6502MemRead readFn;
   vrEmu6502MemWrite writeFn;
+  void* userData;
+
+  /* direct page map (NULL = use readFn/writeFn) */
+  const uint8_t* readPages[256];
+  uint8_t* writePages[256];
 
   vrEmu6502Interrupt intPin;
   vrEmu6502Interrupt nmiPin;
@@ -93,9 +98,30 @@ static const uint8_t UNSTABLE_MAGIC_CONST = 0xee; // common values are 0x00, 0xe
 /* ------------------------------------------------------------------
  *  HELPER FUNCTIONS
  * ----------------------------------------------------------------*/
+
+/*
+ * read a value from memory (mapped pages are accessed directly)
+ */
+inline static uint8_t memRead(VrEmu6502* vr6502, uint16_t addr, bool isDbg)
+{
+  const uint8_t* page = vr6502->readPages[addr >> 8];
+  if (page) return page[addr & 0xff];
+  return vr6502->readFn(vr6502->userData, addr, isDbg);
+}
+
+/*
+ * write a value to memory (mapped pages are accessed directly)
+ */
+inline static void memWrite(VrEmu6502* vr6502, uint16_t addr, uint8_t val)
+{
+  uint8_t* page = vr6502->writePages[addr >> 8];
+  if (page) { page[addr & 0xff] = val; return; }
+  vr6502->writeFn(vr6502->userData, addr, val);
+}
+
 inline static void push(VrEmu6502* vr6502, uint8_t val)
 {
-  vr6502->writeFn(vr6502->spBase | vr6502->sp--, val);
+  memWrite(vr6502, vr6502->spBase | vr6502->sp--, val);
 }
 
 /*
@@ -103,7 +129,7 @@ inline static void push(VrEmu6502* vr6502, uint8_t val)
  */
 inline static uint8_t pop(VrEmu6502* vr6502)
 {
-  return vr6502->readFn(vr6502->spBase | (++vr6502->sp), false);
+  return memRead(vr6502, vr6502->spBase | (++vr6502->sp), false);
 }
 
 /*
@@ -111,7 +137,7 @@ inline static uint8_t pop(VrEmu6502* vr6502)
  */
 inline static uint16_t read16(VrEmu6502* vr6502, uint16_t addr)
 {
-  return vr6502->readFn(addr, false) | (vr6502->readFn(addr + 1, false) << 8);
+  return memRead(vr6502, addr, false) | (memRead(vr6502, addr + 1, false) << 8);
 }
 
 /*
@@ -121,9 +147,9 @@ inline static uint16_t read16Bug(VrEmu6502* vr6502, uint16_t addr)
 {
   if ((addr & 0xff) == 0xff) /* 6502 bug */
   {
-    return vr6502->readFn(addr, false) | (vr6502->readFn(addr & 0xff00, false) << 8);
+    return memRead(vr6502, addr, false) | (memRead(vr6502, addr & 0xff00, false) << 8);
   }
-  return vr6502->readFn(addr, false) | (vr6502->readFn(addr + 1, false) << 8);
+  return memRead(vr6502, addr, false) | (memRead(vr6502, addr + 1, false) << 8);
 }
 
 /*
@@ -131,7 +157,7 @@ inline static uint16_t read16Bug(VrEmu6502* vr6502, uint16_t addr)
  */
 inline static uint16_t read16Wrapped(VrEmu6502* vr6502, uint16_t addr)
 {
-  return vr6502->readFn(addr, false) | (vr6502->readFn((addr + 1) & 0xff, false) << 8);
+  return memRead(vr6502, addr, false) | (memRead(vr6502, (addr + 1) & 0xff, false) << 8);
 }
 
 /*
@@ -214,7 +240,8 @@ static const char* opcodeToMnemonicStr(VrEmu6502* vr6502, uint8_t opcode);
 VR_EMU_6502_DLLEXPORT VrEmu6502* vrEmu6502New(
   vrEmu6502Model model,
   vrEmu6502MemRead readFn,
-  vrEmu6502MemWrite writeFn)
+  vrEmu6502MemWrite writeFn,
+  void* userData)
 {
   assert(readFn);
   assert(writeFn);
@@ -225,6 +252,13 @@ VR_EMU_6502_DLLEXPORT VrEmu6502* vrEmu6502New(
     vr6502->model = model;
     vr6502->readFn = readFn;
     vr6502->writeFn = writeFn;
+    vr6502->userData = userData;
+
+    for (int i = 0; i < 256; ++i)
+    {
+      vr6502->readPages[i] = NULL;
+      vr6502->writePages[i] = NULL;
+    }
 
     vr6502->zpBase = 0x0;
     vr6502->spBase = 0x100;
@@ -356,7 +390,7 @@ VR_EMU_6502_DLLEXPORT void __time_critical_func(vrEmu6502Tick)(VrEmu6502* vr6502
     if (!vr6502->wai)
     {
       vr6502->currentOpcodeAddr = vr6502->pc++;
-      vr6502->currentOpcode = vr6502->readFn(vr6502->currentOpcodeAddr, false);
+      vr6502->currentOpcode = memRead(vr6502, vr6502->currentOpcodeAddr, false);
 
       /* find the instruction in the table */
       const vrEmu6502Opcode* opcode = &vr6502->opcodes[vr6502->currentOpcode];
@@ -413,6 +447,20 @@ VR_EMU_6502_DLLEXPORT vrEmu6502Interrupt* vrEmu6502Nmi(VrEmu6502* vr6502)
   return NULL;
 }
 
+/* ------------------------------------------------------------------
+ *
+ * map a 256-byte page directly to host memory.
+ * readMem/writeMem may be NULL to fall back to readFn/writeFn
+ */
+VR_EMU_6502_DLLEXPORT void vrEmu6502MapPage(VrEmu6502* vr6502, uint8_t page, const uint8_t* readMem, uint8_t* writeMem)
+{
+  if (vr6502)
+  {
+    vr6502->readPages[page] = readMem;
+    vr6502->writePages[page] = writeMem;
+  }
+}
+
 /* ------------------------------------------------------------------
  *
  * return the program counter
@@ -502,7 +550,7 @@ VR_EMU_6502_DLLEXPORT uint16_t vrEmu6502GetCurrentOpcodeAddr(VrEmu6502* vr6502)
  */
 VR_EMU_6502_DLLEXPORT uint8_t vrEmu6502GetNextOpcode(VrEmu6502* vr6502)
 {
-  return vr6502->readFn(vr6502->pc, true);
+  return memRead(vr6502, vr6502->pc, true);
 }
 
 
@@ -549,9 +597,9 @@ uint16_t vrEmu6502DisassembleInstruction(
 {
   if (vr6502)
   {
-    uint8_t opcode = vr6502->readFn(addr, true);
-    uint8_t arg8 = vr6502->readFn(addr + 1, true);
-    uint16_t arg16 = (vr6502->readFn(addr + 2, true) << 8) | arg8;
+    uint8_t opcode = memRead(vr6502, addr, true);
+    uint8_t arg8 = memRead(vr6502, addr + 1, true);
+    uint16_t arg16 = (memRead(vr6502, addr + 2, true) << 8) | arg8;
     const char* mnemonic = vrEmu6502OpcodeToMnemonicStr(vr6502, opcode);
 
     const char* addr8Label = labelMap ? labelMap[arg8] : NULL;
@@ -775,7 +823,7 @@ static uint16_t indx(VrEmu6502* vr6502)
  */
 static uint16_t rel(VrEmu6502* vr6502)
 {
-  int8_t offset = (int8_t)vr6502->readFn(vr6502->pc, false);
+  int8_t offset = (int8_t)memRead(vr6502, vr6502->pc, false);
   return vr6502->pc++ + offset + 1;
 }
 
@@ -784,7 +832,7 @@ static uint16_t rel(VrEmu6502* vr6502)
  */
 static uint16_t xin(VrEmu6502* vr6502)
 {
-  return read16Wrapped(vr6502, (vr6502->zpBase + vr6502->readFn(vr6502->pc++, false) + vr6502->ix) & 0xff);
+  return read16Wrapped(vr6502, (vr6502->zpBase + memRead(vr6502, vr6502->pc++, false) + vr6502->ix) & 0xff);
 }
 
 /*
@@ -792,7 +840,7 @@ static uint16_t xin(VrEmu6502* vr6502)
  */
 static uint16_t yin(VrEmu6502* vr6502)
 {
-  uint16_t base = read16Wrapped(vr6502, vr6502->zpBase + vr6502->readFn(vr6502->pc++, false));
+  uint16_t base = read16Wrapped(vr6502, vr6502->zpBase + memRead(vr6502, vr6502->pc++, false));
   uint16_t addr = base + vr6502->iy;
   return addr;
 }
@@ -802,7 +850,7 @@ static uint16_t yin(VrEmu6502* vr6502)
  */
 static uint16_t yip(VrEmu6502* vr6502)
 {
-  uint16_t base = read16Wrapped(vr6502, vr6502->zpBase + vr6502->readFn(vr6502->pc++, false));
+  uint16_t base = read16Wrapped(vr6502, vr6502->zpBase + memRead(vr6502, vr6502->pc++, false));
   uint16_t addr = base + vr6502->iy;
   pageBoundary(vr6502, base, addr);
   return addr;
@@ -813,7 +861,7 @@ static uint16_t yip(VrEmu6502* vr6502)
  */
 static uint16_t zp(VrEmu6502* vr6502)
 {
-  return vr6502->zpBase + vr6502->readFn(vr6502->pc++, false);
+  return vr6502->zpBase + memRead(vr6502, vr6502->pc++, false);
 }
 
 /*
@@ -821,7 +869,7 @@ static uint16_t zp(VrEmu6502* vr6502)
  */
 static uint16_t zpi(VrEmu6502* vr6502)
 {
-  return read16Wrapped(vr6502, vr6502->zpBase + vr6502->readFn(vr6502->pc++, false));
+  return read16Wrapped(vr6502, vr6502->zpBase + memRead(vr6502, vr6502->pc++, false));
 }
 
 /*
@@ -829,7 +877,7 @@ static uint16_t zpi(VrEmu6502* vr6502)
  */
 static uint16_t zpx(VrEmu6502* vr6502)
 {
-  return vr6502->zpBase + ((vr6502->readFn(vr6502->pc++, false) + vr6502->ix) & 0xff);
+  return vr6502->zpBase + ((memRead(vr6502, vr6502->pc++, false) + vr6502->ix) & 0xff);
 }
 
 /*
@@ -837,7 +885,7 @@ static uint16_t zpx(VrEmu6502* vr6502)
  */
 static uint16_t zpy(VrEmu6502* vr6502)
 {
-  return vr6502->zpBase + ((vr6502->readFn(vr6502->pc++, false) + vr6502->iy) & 0xff);
+  return vr6502->zpBase + ((memRead(vr6502, vr6502->pc++, false) + vr6502->iy) & 0xff);
 }
 
 /*
@@ -868,7 +916,7 @@ static uint16_t tmp(VrEmu6502* vr6502)
     */
 static void adcd(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t value = vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t value = memRead(vr6502, modeAddr(vr6502), false);
 
   uint8_t vu = value & 0x0f;
   uint8_t vt = (value & 0xf0) >> 4;
@@ -928,7 +976,7 @@ static void adc(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
   else
   {
-    uint8_t opr = vr6502->readFn(modeAddr(vr6502), false);
+    uint8_t opr = memRead(vr6502, modeAddr(vr6502), false);
     uint16_t result = vr6502->ac + opr + testBit(vr6502, FlagC);
 
     setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -943,7 +991,7 @@ static void adc(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void and (VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ac &= vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ac &= memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -959,10 +1007,10 @@ static void asl(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t result = vr6502->readFn(addr, false);
+  uint8_t result = memRead(vr6502, addr, false);
   setOrClearBit(vr6502, FlagC, result & 0x80);
   setNZ(vr6502, result <<= 1);
-  vr6502->writeFn(addr, result);
+  memWrite(vr6502, addr, result);
 }
 
 /*
@@ -1006,7 +1054,7 @@ static void beq(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void bit(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t val = vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t val = memRead(vr6502, modeAddr(vr6502), false);
 
   if (modeAddr != imm)
   {
@@ -1124,7 +1172,7 @@ static void clv(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void cmp(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t opr = ~vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t opr = ~memRead(vr6502, modeAddr(vr6502), false);
   uint16_t result = vr6502->ac + opr + 1;
 
   setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -1136,7 +1184,7 @@ static void cmp(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void cpx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t opr = ~vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t opr = ~memRead(vr6502, modeAddr(vr6502), false);
   uint16_t result = vr6502->ix + opr + 1;
 
   setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -1148,7 +1196,7 @@ static void cpx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void cpy(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t opr = ~vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t opr = ~memRead(vr6502, modeAddr(vr6502), false);
   uint16_t result = vr6502->iy + opr + 1;
 
   setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -1167,9 +1215,9 @@ static void dec(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t val = vr6502->readFn(addr, false) - 1;
+  uint8_t val = memRead(vr6502, addr, false) - 1;
   setNZ(vr6502, val);
-  vr6502->writeFn(addr, val);
+  memWrite(vr6502, addr, val);
 }
 
 /*
@@ -1197,7 +1245,7 @@ static void dey(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void eor(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ac ^= vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ac ^= memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1212,9 +1260,9 @@ static void inc(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t val = vr6502->readFn(addr, false) + 1;
+  uint8_t val = memRead(vr6502, addr, false) + 1;
   setNZ(vr6502, val);
-  vr6502->writeFn(addr, val);
+  memWrite(vr6502, addr, val);
 }
 
 /*
@@ -1261,7 +1309,7 @@ static void jsr(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void lda(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ac = vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ac = memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1269,7 +1317,7 @@ static void lda(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void ldx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ix = vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ix = memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1277,7 +1325,7 @@ static void ldx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void ldy(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->iy = vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->iy = memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1293,10 +1341,10 @@ static void lsr(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t result = vr6502->readFn(addr, false);
+  uint8_t result = memRead(vr6502, addr, false);
   setOrClearBit(vr6502, FlagC, result & 0x01);
   setNZ(vr6502, result >>= 1);
-  vr6502->writeFn(addr, result);
+  memWrite(vr6502, addr, result);
 }
 
 /*
@@ -1315,7 +1363,7 @@ static void ldd(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   if (modeAddr)
   {
     /* we still want to read the data (and discard it) */
-    vr6502->readFn(modeAddr(vr6502), false);
+    memRead(vr6502, modeAddr(vr6502), false);
   }
 }
 
@@ -1324,7 +1372,7 @@ static void ldd(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void ora(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ac |= vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ac |= memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1422,12 +1470,12 @@ static void rol(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t val = vr6502->readFn(addr, false);
+  uint8_t val = memRead(vr6502, addr, false);
   bool tc = val & 0x80;
   val = (val << 1) | testBit(vr6502, FlagC);
   setOrClearBit(vr6502, FlagC, tc);
   setNZ(vr6502, val);
-  vr6502->writeFn(addr, val);
+  memWrite(vr6502, addr, val);
 }
 
 /*
@@ -1445,12 +1493,12 @@ static void ror(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
   }
 
   uint16_t addr = modeAddr(vr6502);
-  uint8_t val = vr6502->readFn(addr, false);
+  uint8_t val = memRead(vr6502, addr, false);
   bool tc = val & 0x01;
   val = (val >> 1) | (testBit(vr6502, FlagC) * 0x80);
   setOrClearBit(vr6502, FlagC, tc);
   setNZ(vr6502, val);
-  vr6502->writeFn(addr, val);
+  memWrite(vr6502, addr, val);
 }
 
 /*
@@ -1482,7 +1530,7 @@ static void rts(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void sbcd(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t value = vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t value = memRead(vr6502, modeAddr(vr6502), false);
   uint16_t binResult = vr6502->ac + ~value + testBit(vr6502, FlagC);
 
   uint16_t result = 0;
@@ -1543,7 +1591,7 @@ static void sbc(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
     return;
   }
 
-  uint8_t opr = ~vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t opr = ~memRead(vr6502, modeAddr(vr6502), false);
   uint16_t result = vr6502->ac + opr + testBit(vr6502, FlagC);
 
   setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -1588,7 +1636,7 @@ static void sei(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void sta(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->writeFn(modeAddr(vr6502), vr6502->ac);
+  memWrite(vr6502, modeAddr(vr6502), vr6502->ac);
 }
 
 /*
@@ -1596,7 +1644,7 @@ static void sta(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void stx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->writeFn(modeAddr(vr6502), vr6502->ix);
+  memWrite(vr6502, modeAddr(vr6502), vr6502->ix);
 }
 
 /*
@@ -1604,7 +1652,7 @@ static void stx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void sty(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->writeFn(modeAddr(vr6502), vr6502->iy);
+  memWrite(vr6502, modeAddr(vr6502), vr6502->iy);
 }
 
 /*
@@ -1612,7 +1660,7 @@ static void sty(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void stz(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->writeFn(modeAddr(vr6502), 0);
+  memWrite(vr6502, modeAddr(vr6502), 0);
 }
 
 /*
@@ -1681,8 +1729,8 @@ static void tya(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void trb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
-  uint8_t temp = vr6502->readFn(addr, false);
-  vr6502->writeFn(addr, temp & ~vr6502->ac);
+  uint8_t temp = memRead(vr6502, addr, false);
+  memWrite(vr6502, addr, temp & ~vr6502->ac);
   setOrClearBit(vr6502, FlagZ, !(temp & vr6502->ac));
 }
 
@@ -1692,8 +1740,8 @@ static void trb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void tsb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
-  uint8_t temp = vr6502->readFn(addr, false);
-  vr6502->writeFn(addr, temp | vr6502->ac);
+  uint8_t temp = memRead(vr6502, addr, false);
+  memWrite(vr6502, addr, temp | vr6502->ac);
   setOrClearBit(vr6502, FlagZ, !(temp & vr6502->ac));
 }
 
@@ -1703,7 +1751,7 @@ static void tsb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void rmb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr, int bitIndex)
 {
   uint16_t addr = modeAddr(vr6502);
-  vr6502->writeFn(addr, vr6502->readFn(addr, false) & ~(0x01 << bitIndex));
+  memWrite(vr6502, addr, memRead(vr6502, addr, false) & ~(0x01 << bitIndex));
 }
 
 static void rmb0(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr) { rmb(vr6502, modeAddr, 0); }
@@ -1722,7 +1770,7 @@ static void rmb7(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr) { rmb(vr6502,
 static void smb(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr, int bitIndex)
 {
   uint16_t addr = modeAddr(vr6502);
-  vr6502->writeFn(addr, vr6502->readFn(addr, false) | (0x01 << bitIndex));
+  memWrite(vr6502, addr, memRead(vr6502, addr, false) | (0x01 << bitIndex));
 }
 
 static void smb0(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr) { smb(vr6502, modeAddr, 0); }
@@ -1739,7 +1787,7 @@ static void smb7(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr) { smb(vr6502,
  */
 static void bbr(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr, int bitIndex)
 {
-  uint8_t val = vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t val = memRead(vr6502, modeAddr(vr6502), false);
   if (!(val & (0x01 << bitIndex)))
   {
     vr6502->pc = rel(vr6502);
@@ -1764,7 +1812,7 @@ static void bbr7(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr) { bbr(vr6502,
  */
 static void bbs(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr, int bitIndex)
 {
-  uint8_t val = vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t val = memRead(vr6502, modeAddr(vr6502), false);
   if ((val & (0x01 << bitIndex)))
   {
     vr6502->pc = rel(vr6502);
@@ -1861,7 +1909,7 @@ static void rra(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void sax(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->writeFn(modeAddr(vr6502), vr6502->ac & vr6502->ix);
+  memWrite(vr6502, modeAddr(vr6502), vr6502->ac & vr6502->ix);
 }
 
 /*
@@ -1869,7 +1917,7 @@ static void sax(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void lax(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  setNZ(vr6502, vr6502->ac = vr6502->ix = vr6502->readFn(modeAddr(vr6502), false));
+  setNZ(vr6502, vr6502->ac = vr6502->ix = memRead(vr6502, modeAddr(vr6502), false));
 }
 
 /*
@@ -1925,7 +1973,7 @@ static void arr(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void sbx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  uint8_t opr = ~vr6502->readFn(modeAddr(vr6502), false);
+  uint8_t opr = ~memRead(vr6502, modeAddr(vr6502), false);
   uint16_t result = (vr6502->ac & vr6502->ix) + opr + 1;
 
   setOrClearBit(vr6502, FlagC, result > 0xff);
@@ -1937,7 +1985,7 @@ static void sbx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
  */
 static void las(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
-  vr6502->sp &= vr6502->readFn(modeAddr(vr6502), false);
+  vr6502->sp &= memRead(vr6502, modeAddr(vr6502), false);
   setNZ(vr6502, vr6502->ac = vr6502->ix = vr6502->sp);
 }
 
@@ -1947,7 +1995,7 @@ static void las(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void sha(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
-  vr6502->writeFn(addr, vr6502->ac & vr6502->ix & (uint8_t)((addr >> 8) + 1));
+  memWrite(vr6502, addr, vr6502->ac & vr6502->ix & (uint8_t)((addr >> 8) + 1));
 }
 
 /*
@@ -1956,7 +2004,7 @@ static void sha(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void shx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
-  vr6502->writeFn(addr, vr6502->ix & (uint8_t)((addr >> 8) + 1));
+  memWrite(vr6502, addr, vr6502->ix & (uint8_t)((addr >> 8) + 1));
 }
 
 /*
@@ -1965,7 +2013,7 @@ static void shx(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void shy(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
-  vr6502->writeFn(addr, vr6502->iy & (uint8_t)((addr >> 8) + 1));
+  memWrite(vr6502, addr, vr6502->iy & (uint8_t)((addr >> 8) + 1));
 }
 
 /*
@@ -1975,7 +2023,7 @@ static void tas(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   uint16_t addr = modeAddr(vr6502);
   vr6502->sp = vr6502->ac & vr6502->ix;
-  vr6502->writeFn(addr, vr6502->sp & (uint8_t)((addr >> 8) + 1));
+  memWrite(vr6502, addr, vr6502->sp & (uint8_t)((addr >> 8) + 1));
 }
 
 /*
@@ -1985,7 +2033,7 @@ static void tas(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void ane(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   vr6502->ac = (vr6502->ac | UNSTABLE_MAGIC_CONST) & vr6502->ix;
-  vr6502->ac &= vr6502->readFn(modeAddr(vr6502), false);
+  vr6502->ac &= memRead(vr6502, modeAddr(vr6502), false);
   setNZ(vr6502, vr6502->ac);
 }
 
@@ -1995,7 +2043,7 @@ static void ane(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 static void lxa(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   vr6502->ac = (vr6502->ac | UNSTABLE_MAGIC_CONST);
-  vr6502->ac &= vr6502->readFn(modeAddr(vr6502), false);
+  vr6502->ac &= memRead(vr6502, modeAddr(vr6502), false);
   setNZ(vr6502, vr6502->ac);
 }
 
@@ -2006,7 +2054,7 @@ static void jam(VrEmu6502* vr6502, vrEmu6502AddrModeFn modeAddr)
 {
   (void)modeAddr;
 
-  vr6502->readFn(imm(vr6502), false);
+  memRead(vr6502, imm(vr6502), false);
   vr6502->stp = true;
 }
 
@@ -126,7 +126,7 @@ typedef enum
  /*
   * memory write function pointer
   */
-typedef void(*vrEmu6502MemWrite)(uint16_t addr, uint8_t val);
+typedef void(*vrEmu6502MemWrite)(void* userData, uint16_t addr, uint8_t val);
 
 /*
   * memory read function pointer
@@ -137,18 +137,21 @@ typedef void(*vrEmu6502MemWrite)(uint16_t addr, uint8_t val);
   *        however it can be true when querying the memory 
   *        for other purposes. devices should NOT change state
   *        when isDbg is true.
-  *        
+  *
+  * userData: the pointer given to vrEmu6502New (per-instance context)
   */
-typedef uint8_t(*vrEmu6502MemRead)(uint16_t addr, bool isDbg);
+typedef uint8_t(*vrEmu6502MemRead)(void* userData, uint16_t addr, bool isDbg);
 
 
 /*
  * create a new 6502
+ * userData is passed back to readFn/writeFn
  */
 VR_EMU_6502_DLLEXPORT VrEmu6502* vrEmu6502New(
                                     vrEmu6502Model model,
                                     vrEmu6502MemRead readFn,
-                                    vrEmu6502MemWrite writeFn);
+                                    vrEmu6502MemWrite writeFn,
+                                    void* userData);
 
 /* ------------------------------------------------------------------
  *
@@ -188,6 +191,14 @@ VR_EMU_6502_DLLEXPORT vrEmu6502Interrupt *vrEmu6502Int(VrEmu6502* vr6502);
  */
 VR_EMU_6502_DLLEXPORT vrEmu6502Interrupt *vrEmu6502Nmi(VrEmu6502* vr6502);
 
+/* ------------------------------------------------------------------
+ *
+ * map a 256-byte page directly to host memory.
+ * accesses to mapped pages bypass readFn/writeFn.
+ * readMem/writeMem may be NULL to fall back to readFn/writeFn
+ */
+VR_EMU_6502_DLLEXPORT void vrEmu6502MapPage(VrEmu6502* vr6502, uint8_t page, const uint8_t* readMem, uint8_t* writeMem);
+
 /* ------------------------------------------------------------------
  *
  * return the program counter
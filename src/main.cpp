@@ -9,14 +9,18 @@
 #include "lib/sokol/sokol_imgui.h" // ImGui 統合
 
 #include "FxtSystem.hpp"
+#include "Cpu.hpp"
 #include "Chdz.hpp"
 #include "Ps2.hpp"
 #include "Psg.hpp"
 #include "Ui.hpp"
+#include "EmuThread.hpp"
+#include "Prof.hpp"
 
 #include <cstdio>
 #include <cstdlib>
 #include <algorithm> // std::min
+#include <chrono>
 #include <string>
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -42,14 +46,12 @@ static constexpr int   WINDOW_W         = 1024;   // 表示サイズ
 static constexpr int   WINDOW_H         = 768;
 static constexpr float PADDING_PX       = 20.0f;  // ウィンドウ内の余白 [px]
 static constexpr int   AUDIO_SAMPLE_RATE = 44100; // 音声サンプルレート [Hz]
-static constexpr int   AUDIO_BUF_SIZE   = 2048;   // 音声バッファサイズ [サンプル]
-static constexpr float INT16_FULL_SCALE = 32768.0f; // int16_t→float 正規化係数
 
 // ---------------------------------------------------------------
 //  グローバル状態
 // ---------------------------------------------------------------
-// FxT-65システム (sokol_impl.mm からアクセスするため外部リンケージ)
-Fxt::System  g_sys;
+// FxT-65システム
+static Fxt::System g_sys;
 // UI 状態
 static Fxt::Ui::State g_ui;
 // sokol
@@ -59,8 +61,15 @@ static sg_view      g_view;     // テクスチャビュー
 static sg_sampler   g_sampler;  // テクスチャサンプリング方法
 static sg_bindings  g_bind;     // シェーダ用リソースバインド情報
 static sg_pass_action g_pass_action;  // レンダーパス開始時の動作
+#if FXT_EMU_THREAD
+// エミュレーションスレッド (フレームバッファ・音声・入力の受け渡しを含む)
+static Fxt::EmuThread::State g_emu;
+// エミュレーションスレッドへ送った入力の数
+static uint32_t     g_inputs_sent = 0;
+#else
 // 描画用バッファ CRTCエミュレータに書き込まれ、sokolが参照
 static uint32_t     g_pixels[DISPLAY_W * DISPLAY_H];
+#endif
 
 // アスペクト比維持用ユニフォーム
 // offset_y: メニュー/ステータスバーを考慮した Y 方向オフセット (NDC)
@@ -72,11 +81,31 @@ static std::string g_cmd_queue;
 // cmdキュー送出開始までの待機フレーム数 (cmd_delay=N で変更可, デフォルト 30 ≈ 0.5秒)
 static int g_cmd_delay_frames = 30;
 
+// ホットスポット計測の書き出し先 (hotspot=BASE → BASE.csv / BASE.json)
+static std::string g_hotspot_base = "hotspot";
+static bool        g_hotspot_boot = false; // 起動時から計測する
+
+// シンボルファイル (sym=PATHS、カンマ区切り)
+static std::string g_sym_paths;
+
+#if FXT_OPSTATS
+// オペコード統計の書き出し先 (opstats=BASE, 空なら計測しない) と計時の間隔 (opstats_sample=N)
+static std::string g_opstats_base;
+static int         g_opstats_sample = 16;
+#endif
+
+#if FXT_PROF
+// プロファイラの出力先 (prof=FILE, 空なら無効) とサンプリング周波数 (prof_hz=N)
+static std::string g_prof_path;
+static int         g_prof_hz = 1000;
+#endif
+
 // ---------------------------------------------------------------
 //  platform_open_vhd 宣言 (macOS 実装は sokol_impl.mm)
+//  選んだイメージを sys の SD カードとしてマウントする
 // ---------------------------------------------------------------
 #ifndef __EMSCRIPTEN__
-void platform_open_vhd(void);
+void platform_open_vhd(Fxt::System& sys);
 #endif
 
 // ---------------------------------------------------------------
@@ -206,6 +235,51 @@ static TerminalSession* g_term = nullptr;
 
 #include "Shaders.hpp"
 
+// ---------------------------------------------------------------
+//  エミュレータへの入力
+//  スレッド実行時はキュー経由でエミュレーションスレッドに渡す
+// ---------------------------------------------------------------
+static void send_uart(int ch)
+{
+#if FXT_EMU_THREAD
+  if (Fxt::EmuThread::Send(g_emu, Fxt::EmuThread::Input::UART, ch)) g_inputs_sent++;
+#else
+  Fxt::UartInput(g_sys, ch);
+#endif
+}
+
+static void send_key(bool down, int key)
+{
+#if FXT_EMU_THREAD
+  using Fxt::EmuThread::Input;
+  if (Fxt::EmuThread::Send(g_emu, down ? Input::KEY_DOWN : Input::KEY_UP, key)) g_inputs_sent++;
+#else
+  if (down) Ps2::KeyDown(g_sys, key);
+  else      Ps2::KeyUp(g_sys, key);
+#endif
+}
+
+static void send_reset(bool hard)
+{
+#if FXT_EMU_THREAD
+  using Fxt::EmuThread::Input;
+  if (Fxt::EmuThread::Send(g_emu, hard ? Input::HARD_RESET : Input::RESET)) g_inputs_sent++;
+#else
+  if (hard) Fxt::Init(g_sys);
+  else      Fxt::Cpu::Reset(g_sys);
+#endif
+}
+
+#if FXT_EMU_THREAD
+// sokol_audio ストリームコールバック (音声スレッド): 足りない分は無音
+static void audio_stream_cb(float* buffer, int num_frames, int num_channels)
+{
+  int count = num_frames * num_channels;
+  int n = Fxt::EmuThread::ReadAudio(g_emu, buffer, count);
+  for (; n < count; n++) buffer[n] = 0.0f;
+}
+#endif
+
 // ---------------------------------------------------------------
 //  init_cb
 // ---------------------------------------------------------------
@@ -217,8 +291,12 @@ static void init_cb(void)
     audio_desc.num_channels = 1;
     audio_desc.sample_rate  = AUDIO_SAMPLE_RATE;
     audio_desc.logger.func  = slog_func;
+#if FXT_EMU_THREAD
+    audio_desc.stream_cb    = audio_stream_cb;
+#endif
     saudio_setup(&audio_desc);
     Psg::Init(g_sys.psg, saudio_sample_rate()); // 実際のレートで初期化
+    g_sys.cfg.audio_hz = saudio_sample_rate();  // このレートでサンプリング
   }
 
   // sokol_gfx 初期化
@@ -238,6 +316,10 @@ static void init_cb(void)
     return;
   }
 
+  // シンボル (sym=PATHS、省略時は ROM と同じ名前の .dbg / .map / .lbl)
+  if (!g_sym_paths.empty()) Fxt::Symbols::LoadList(g_sys.symbols, g_sym_paths);
+  else                      Fxt::Symbols::LoadForRom(g_sys.symbols, "assets/rom.bin");
+
   // SD カードイメージをマウント (.vhd → .img の順で試行)
   if (!Fxt::Sd::MountImg(g_sys, "sdcard.vhd") &&
       !Fxt::Sd::MountImg(g_sys, "sdcard.img"))
@@ -348,6 +430,22 @@ static void init_cb(void)
   // パスアクション (黒クリア)
   g_pass_action.colors[0].load_action = SG_LOADACTION_CLEAR;
   g_pass_action.colors[0].clear_value = {0.0f, 0.0f, 0.0f, 1.0f};
+
+  if (g_hotspot_boot)
+  {
+    Fxt::Hotspot::Start(g_sys);
+    g_ui.hotspot_active = true;
+  }
+#if FXT_OPSTATS
+  if (!g_opstats_base.empty()) Fxt::OpStats::Start(g_sys, g_opstats_sample);
+#endif
+#if FXT_PROF
+  if (!g_prof_path.empty()) Fxt::Prof::Start(g_prof_path.c_str(), g_prof_hz);
+#endif
+#if FXT_EMU_THREAD
+  // ここから System はエミュレーションスレッドが持つ
+  Fxt::EmuThread::Start(g_emu, g_sys);
+#endif
 }
 
 // ---------------------------------------------------------------
@@ -356,22 +454,12 @@ static void init_cb(void)
 #ifndef __EMSCRIPTEN__
 static int   g_input_cnt  = 0;
 #endif
-static int   g_audio_acc  = 0;
-static float g_audio_buf[AUDIO_BUF_SIZE];
 
-// UART 入力を処理するヘルパー
-static void process_uart_input(int ch)
+// 性能モニタ用の区間計測
+typedef std::chrono::steady_clock PerfClock;
+static float perf_ms(PerfClock::time_point t0, PerfClock::time_point t1)
 {
-  if (ch == 0x7F) ch = 0x08; // DEL → BS
-  g_sys.uart_input_buffer = (uint8_t)ch;
-  g_sys.uart_status |= 0b00001000;
-  Fxt::UpdateIrq(g_sys);
-  if (ch == ('N' - 0x40)) // Ctrl+N: NMI
-  {
-    Fxt::RequestNmi(g_sys);
-    for (int i = 0; i < 10; i++) Fxt::Tick(g_sys);
-    Fxt::ClearNmi(g_sys);
-  }
+  return std::chrono::duration<float, std::milli>(t1 - t0).count();
 }
 
 static void frame_cb(void)
@@ -380,8 +468,16 @@ static void frame_cb(void)
   float win_h = sapp_heightf();
 
   // ImGui 新フレーム開始
-  Fxt::Ui::NewFrame((int)win_w, (int)win_h,
-                    sapp_frame_duration(), sapp_dpi_scale());
+  {
+    FXT_PROF_ZONE(IMGUI);
+    Fxt::Ui::NewFrame((int)win_w, (int)win_h,
+                      sapp_frame_duration(), sapp_dpi_scale());
+  }
+
+#if FXT_EMU_THREAD
+  // エミュレーションスレッドが出した最新フレーム
+  const Fxt::EmuThread::Frame& frame = Fxt::EmuThread::Acquire(g_emu);
+#endif
 
 #ifdef __EMSCRIPTEN__
   // Web: JavaScript の uartInputQueue からフレームごとにポーリング
@@ -390,7 +486,7 @@ static void frame_cb(void)
       return (typeof uartInputQueue !== 'undefined' && uartInputQueue.length > 0)
         ? uartInputQueue.shift() : -1;
     });
-    if (ch >= 0) process_uart_input(ch);
+    if (ch >= 0) send_uart(ch);
   }
 #else
   // ネイティブ: 標準入力処理 (4096サイクルに1回)
@@ -399,13 +495,19 @@ static void frame_cb(void)
   {
     g_input_cnt = 0;
     int ch = getchar();
-    if (ch != EOF) process_uart_input(ch);
+    if (ch != EOF) send_uart(ch);
   }
 #endif
 
   // 起動時コマンドキュー: OS 初期化完了後に 1 文字ずつ UART へ送出
   // 遅延でOS起動を待つ
   {
+#if FXT_EMU_THREAD
+    // 送った入力がすべて処理され、受信データが読まれたフレームを見てから次を送る
+    bool uart_ready = frame.inputs == g_inputs_sent && !frame.uart_rx_full;
+#else
+    bool uart_ready = !(g_sys.uart_status & 0b00001000);
+#endif
     static int s_cmd_delay_remain = g_cmd_delay_frames;
     if (!g_cmd_queue.empty())
     {
@@ -413,48 +515,54 @@ static void frame_cb(void)
       {
         --s_cmd_delay_remain;
       }
-      else if (!(g_sys.uart_status & 0b00001000))
+      else if (uart_ready)
       {
-        process_uart_input((unsigned char)g_cmd_queue.front());
+        send_uart((unsigned char)g_cmd_queue.front());
         g_cmd_queue.erase(g_cmd_queue.begin());
       }
     }
   }
 
-  // エミュレーション実行
-  int tpf = g_sys.cfg.ticks_per_frame();  // 1フレームあたり何ティックか
-  int audio_count = 0;                    // バッファのインデックス
-  int sr  = saudio_sample_rate();         // 音声サンプリングレート
-  for (int i = 0; i < tpf; i++)
-  {
-    // FxT-65のティック=CPUクロックを進める
-    Fxt::Tick(g_sys);
-
-    // 音声サンプリング（CPUクロックよりも低頻度）
-    // cpu_hzに対して、sr/cpu_hz の頻度で実行
-    g_audio_acc += sr;
-    if (g_audio_acc >= g_sys.cfg.cpu_hz)
-    {
-      // カウンタをリセットするが端数を保存
-      g_audio_acc -= g_sys.cfg.cpu_hz;
-      // PSG出力信号レベル（16bit int）を正規化して音声出力
-      if (audio_count < AUDIO_BUF_SIZE)
-      {
-        g_audio_buf[audio_count++] = Psg::Calc(g_sys.psg) / INT16_FULL_SCALE;
-      }
-    }
-  }
-  saudio_push(g_audio_buf, audio_count);
+#if FXT_EMU_THREAD
+  // 実行・フレームバッファレンダリングはエミュレーションスレッドが行う
+  const uint32_t* pixels = frame.pixels;
+  Fxt::Ui::Status status;
+  status.regs       = frame.regs;
+  status.sd_mounted = frame.sd_mounted;
+  status.cycles     = frame.cycles;
+  status.symbols    = &g_sys.symbols;
+  status.emu_ms     = frame.run_ms;
+  status.render_ms  = frame.render_ms;
+  status.sd_sectors = frame.sd_sectors;
+  status.target_hz  = frame.target_hz;
+  if (saudio_sample_rate() > 0)
+    status.audio_ms = Fxt::EmuThread::AudioQueued(g_emu) * 1000.0f / saudio_sample_rate();
+#else
+  // エミュレーション実行 (命令単位、周辺機器・音声サンプリングはイベントで追従)
+  PerfClock::time_point t_run = PerfClock::now();
+  Fxt::RunCycles(g_sys, (uint64_t)g_sys.cfg.ticks_per_frame());
+  saudio_push(g_sys.audio_buf, g_sys.audio_count);
+  g_sys.audio_count = 0;
 
   // フレームバッファレンダリング
+  PerfClock::time_point t_render = PerfClock::now();
   Chdz::RenderFrame(g_sys.chdz, g_pixels);
+  const uint32_t* pixels = g_pixels;
+  Fxt::Ui::Status status = Fxt::Ui::GetStatus(g_sys);
+  status.emu_ms    = perf_ms(t_run, t_render);
+  status.render_ms = perf_ms(t_render, PerfClock::now());
+  // 音声の残量は sokol_audio のバッファ容量が取れないので出さない
+#endif
 
   // テクスチャ更新
   {
+    FXT_PROF_ZONE(TEXTURE);
+    PerfClock::time_point t_tex = PerfClock::now();
     sg_image_data img_data = {};
-    img_data.mip_levels[0].ptr  = g_pixels;
-    img_data.mip_levels[0].size = sizeof(g_pixels);
+    img_data.mip_levels[0].ptr  = pixels;
+    img_data.mip_levels[0].size = DISPLAY_W * DISPLAY_H * sizeof(uint32_t);
     sg_update_image(g_image, &img_data);
+    status.texture_ms = perf_ms(t_tex, PerfClock::now());
   }
 
   // フルスクリーンクワッド描画
@@ -469,7 +577,10 @@ static void frame_cb(void)
   sg_draw(0, 4, 1);
 
   // UI レンダリング (ImGui ウィジェット構築 + GPU 描画)
-  Fxt::Ui::Render(g_ui, g_sys, win_w, win_h);
+  {
+    FXT_PROF_ZONE(IMGUI);
+    Fxt::Ui::Render(g_ui, status, win_w, win_h);
+  }
 
   sg_end_pass();
   sg_commit();
@@ -477,14 +588,35 @@ static void frame_cb(void)
   // UI リクエスト処理
   if (g_ui.request_reset)
   {
-    vrEmu6502Reset(g_sys.cpu);
+    send_reset(false);
     g_ui.request_reset = false;
   }
   if (g_ui.request_hard_reset)
   {
-    Fxt::Init(g_sys);
+    send_reset(true);
     g_ui.request_hard_reset = false;
   }
+  if (g_ui.request_hotspot)
+  {
+    // 計測の開始・終了 (終了時にカウンタを書き出す)
+#if FXT_EMU_THREAD
+    Fxt::EmuThread::Pause(g_emu);
+#endif
+    if (g_sys.hotspot)
+    {
+      Fxt::Hotspot::Dump(g_sys, g_hotspot_base);
+      Fxt::Hotspot::Stop(g_sys);
+    }
+    else
+    {
+      Fxt::Hotspot::Start(g_sys);
+    }
+#if FXT_EMU_THREAD
+    Fxt::EmuThread::Resume(g_emu);
+#endif
+    g_ui.hotspot_active  = g_sys.hotspot != nullptr;
+    g_ui.request_hotspot = false;
+  }
 #ifdef __EMSCRIPTEN__
   if (g_ui.request_vhd_load)
   {
@@ -499,7 +631,14 @@ static void frame_cb(void)
 #else
   if (g_ui.request_vhd_load)
   {
-    platform_open_vhd();
+    // ダイアログ中はエミュレーションを止め、SD イメージを差し替える
+#if FXT_EMU_THREAD
+    Fxt::EmuThread::Pause(g_emu);
+#endif
+    platform_open_vhd(g_sys);
+#if FXT_EMU_THREAD
+    Fxt::EmuThread::Resume(g_emu);
+#endif
     g_ui.request_vhd_load = false;
   }
 #endif
@@ -580,18 +719,18 @@ static void event_cb(const sapp_event* ev)
         if (ch >= 0)
         {
           if (ev->modifiers & SAPP_MODIFIER_CTRL) ch &= 0x1F;
-          process_uart_input(ch);
+          send_uart(ch);
         }
         else
         {
-          Ps2::KeyDown(g_sys.ps2, (int)ev->key_code);
+          send_key(true, (int)ev->key_code);
         }
       }
       else
 #endif
       {
         // PS/2キーボードとして入力
-        Ps2::KeyDown(g_sys.ps2, (int)ev->key_code);
+        send_key(true, (int)ev->key_code);
       }
       break;
 
@@ -599,7 +738,7 @@ static void event_cb(const sapp_event* ev)
 #ifndef __EMSCRIPTEN__
       if (!keyin_to_uart)
 #endif
-        Ps2::KeyUp(g_sys.ps2, (int)ev->key_code);
+        send_key(false, (int)ev->key_code);
       break;
 
     case SAPP_EVENTTYPE_RESIZED:
@@ -636,6 +775,22 @@ static void signal_cleanup(int sig)
 // ---------------------------------------------------------------
 static void cleanup_cb(void)
 {
+#if FXT_EMU_THREAD
+  // 以降は System をこのスレッドから触る
+  Fxt::EmuThread::Stop(g_emu);
+#endif
+#if FXT_PROF
+  // フラットプロファイルを標準エラーへ、folded stacks を prof= のファイルへ
+  Fxt::Prof::Stop(stderr, &g_sys.symbols);
+#endif
+  // ホットスポット計測中なら書き出す
+  Fxt::Hotspot::Dump(g_sys, g_hotspot_base);
+  Fxt::Hotspot::Stop(g_sys);
+#if FXT_OPSTATS
+  // オペコード統計を opstats= の名前で書き出す
+  Fxt::OpStats::Dump(g_sys, g_opstats_base);
+  Fxt::OpStats::Stop(g_sys);
+#endif
 #ifdef FXT_HAS_TERM_IO
   restore_terminal();
 #endif
@@ -645,6 +800,17 @@ static void cleanup_cb(void)
   sargs_shutdown();
   Psg::Shutdown(g_sys.psg);
   Fxt::Sd::UnmountImg(g_sys);
+#if !FXT_CPU_VREMU
+  // トレースキャッシュ使用時は融合命令の統計を出力
+  Fxt::Trace::DumpStats(g_sys, stderr);
+  // 待機ループ・遅延ループの検出で飛ばしたサイクル数
+  if (g_sys.cpu.idle_skipped)
+    fprintf(stderr, "idle loop: %llu / %llu cycles skipped\n",
+            (unsigned long long)g_sys.cpu.idle_skipped, (unsigned long long)g_sys.sched.now);
+  if (g_sys.cpu.delay_skipped)
+    fprintf(stderr, "delay loop: %llu / %llu cycles skipped\n",
+            (unsigned long long)g_sys.cpu.delay_skipped, (unsigned long long)g_sys.sched.now);
+#endif
 }
 
 // ---------------------------------------------------------------
@@ -672,6 +838,46 @@ sapp_desc sokol_main(int argc, char* argv[])
   if (sargs_exists("speed"))
     g_sys.cfg.sim_speed = (float)atof(sargs_value("speed"));
 
+  // JIT jit=0 で無効 (JIT=1 ビルドのみ)
+  if (sargs_exists("jit"))
+    g_sys.cfg.jit = atoi(sargs_value("jit")) != 0;
+
+  // ROM の事前変換コード aot=0 で無効 (ROM_AOT=1 ビルドのみ)
+  if (sargs_exists("aot"))
+    g_sys.cfg.rom_aot = atoi(sargs_value("aot")) != 0;
+
+  // トレースキャッシュ trace=1 で有効 (native コアのみ、終了時に融合命令の統計を出力)
+  if (sargs_exists("trace"))
+    g_sys.cfg.trace = atoi(sargs_value("trace")) != 0;
+
+  // ホットスポット計測 hotspot=BASE で起動時から計測し、終了時に BASE.csv / BASE.json へ書き出す
+  // (メニューから終了したときも同じ名前に書き出す)
+  if (sargs_exists("hotspot"))
+  {
+    g_hotspot_base = sargs_value("hotspot");
+    g_hotspot_boot = true;
+  }
+
+  // シンボルファイル sym=a.dbg,b.lbl (cc65 .dbg / .map / VICE ラベル)
+  if (sargs_exists("sym"))
+    g_sym_paths = sargs_value("sym");
+
+#if FXT_OPSTATS
+  // オペコード統計 opstats=BASE で起動時から計測 (OPSTATS=1 ビルドのみ)、opstats_sample=N 命令に1回計時
+  if (sargs_exists("opstats"))
+    g_opstats_base = sargs_value("opstats");
+  if (sargs_exists("opstats_sample"))
+    g_opstats_sample = atoi(sargs_value("opstats_sample"));
+#endif
+
+#if FXT_PROF
+  // プロファイラ prof=FILE で開始 (PROF=1 ビルドのみ)、prof_hz=N でサンプリング周波数
+  if (sargs_exists("prof"))
+    g_prof_path = sargs_value("prof");
+  if (sargs_exists("prof_hz"))
+    g_prof_hz = atoi(sargs_value("prof_hz"));
+#endif
+
   // cmd_delay=N : cmdキュー送出開始までの待機フレーム数 (デフォルト 30 ≈ 0.5秒)
   if (sargs_exists("cmd_delay"))
     g_cmd_delay_frames = atoi(sargs_value("cmd_delay"));
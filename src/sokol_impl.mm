@@ -59,9 +59,7 @@ extern "C" const char* platform_get_ui_font_path(void)
 //  NSOpenPanel で .vhd / .img を選択し、SD カードをマウントする
 // ---------------------------------------------------------------
 
-extern Fxt::System g_sys; // main.cpp で定義
-
-void platform_open_vhd(void)
+void platform_open_vhd(Fxt::System& sys)
 {
   @autoreleasepool {
     NSOpenPanel* panel = [NSOpenPanel openPanel];
@@ -80,8 +78,8 @@ void platform_open_vhd(void)
       if (url)
       {
         std::string path = url.fileSystemRepresentation;
-        Fxt::Sd::UnmountImg(g_sys);
-        if (!Fxt::Sd::MountImg(g_sys, path))
+        Fxt::Sd::UnmountImg(sys);
+        if (!Fxt::Sd::MountImg(sys, path))
         {
           NSAlert* alert = [[NSAlert alloc] init];
           alert.messageText = @"SDカードイメージを開けませんでした";
@@ -27,8 +27,6 @@
 #include "FxtSystem.hpp"
 #include "Sd.hpp"
 
-extern Fxt::System g_sys; // main.cpp で定義
-
 static bool file_exists(const char* path)
 {
   struct stat st;
@@ -98,7 +96,7 @@ extern "C" const char* platform_get_ui_font_path(void)
 //  Linux VHD ファイルピッカー
 //  zenity で .vhd / .img を選択し、SD カードをマウントする
 // ---------------------------------------------------------------
-void platform_open_vhd(void)
+void platform_open_vhd(Fxt::System& sys)
 {
   const char* cmd =
     "zenity --file-selection "
@@ -120,8 +118,8 @@ void platform_open_vhd(void)
   if (buf[0] == '\0') return;
 
   std::string path = buf;
-  Fxt::Sd::UnmountImg(g_sys);
-  if (!Fxt::Sd::MountImg(g_sys, path))
+  Fxt::Sd::UnmountImg(sys);
+  if (!Fxt::Sd::MountImg(sys, path))
   {
     // エラーはダイアログで通知 (zenity が無い場合は stderr)
     std::string err = "zenity --error --title='SDカード' "
@@ -28,8 +28,6 @@
 #include "FxtSystem.hpp"
 #include "Sd.hpp"
 
-extern Fxt::System g_sys; // main.cpp で定義
-
 static bool file_exists_w(const char* path)
 {
   if (!path || !path[0]) return false;
@@ -91,7 +89,7 @@ extern "C" const char* platform_get_ui_font_path(void)
 //  Windows VHD ファイルピッカー
 //  GetOpenFileName で .vhd / .img を選択し、SD カードをマウントする
 // ---------------------------------------------------------------
-void platform_open_vhd(void)
+void platform_open_vhd(Fxt::System& sys)
 {
   char file_buf[MAX_PATH] = "";
   OPENFILENAMEA ofn;
@@ -110,8 +108,8 @@ void platform_open_vhd(void)
   if (file_buf[0] == '\0')   return;
 
   std::string path = file_buf;
-  Fxt::Sd::UnmountImg(g_sys);
-  if (!Fxt::Sd::MountImg(g_sys, path))
+  Fxt::Sd::UnmountImg(sys);
+  if (!Fxt::Sd::MountImg(sys, path))
   {
     std::string msg = "SDカードイメージを開けませんでした:\n";
     msg += path;
@@ -0,0 +1,198 @@
+/* src/test/W65c02Diff.cpp - W65c02::Run と InstCycle の差分テスト (外部依存なし)
+ *
+ * 待機ループ・遅延ループの省略 (OnLoopBranch) と WAI の早送り (SkipWait) が
+ * 1命令ずつ実行した場合とサイクル単位で一致することを確かめる。
+ * 乱数で埋めたメモリにループの断片を散らしたプログラムを、同じ初期状態の CPU 2つで
+ *   - A: Run (スライスの終わり target と次のイベント next_due を乱数で与える)
+ *   - B: A が止まったサイクルまで InstCycle を繰り返す
+ * と進め、スライスごとにレジスタ・サイクル数・メモリを比べる。
+ * スライスの境目 (イベント) で IRQ 線の上げ下げと NMI を乱数で入れる。
+ * $E000-$E0FF は読むたびに値が変わる I/O として扱い、PureRead は false を返す。
+ *
+ *   ./fxt65-test [key=value ...]
+ *     seeds=N     試すプログラムの数 (既定 300)
+ *     seed=N      このシードだけ試す
+ *     cycles=N    1プログラムあたりのサイクル数 (既定 2000000)
+ *   不一致があれば内容を表示して 1 で終わる。
+ */
+
+#include "../W65c02.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace Fxt;
+
+// ---------------------------------------------------------------
+//  テスト用のバス
+// ---------------------------------------------------------------
+struct TestBus
+{
+  uint8_t  mem[0x10000];
+  uint32_t io_reads = 0; // I/O の読み出し回数 (読むたびに値が変わる)
+
+  static bool IsIo(uint16_t addr) { return (addr & 0xFF00) == 0xE000; }
+
+  uint8_t Read(uint16_t addr)
+  {
+    if (IsIo(addr)) return (uint8_t)(mem[addr] + io_reads++);
+    return mem[addr];
+  }
+  void    Write(uint16_t addr, uint8_t val) { if (!IsIo(addr)) mem[addr] = val; }
+  uint8_t Fetch(uint16_t addr) { return Read(addr); }
+  bool    PureRead(uint16_t addr) { return !IsIo(addr); }
+};
+
+static TestBus g_bus_a, g_bus_b;
+
+// xorshift32
+static uint32_t g_rs;
+static uint32_t Rand()
+{
+  g_rs ^= g_rs << 13;
+  g_rs ^= g_rs >> 17;
+  g_rs ^= g_rs << 5;
+  return g_rs;
+}
+
+// ---------------------------------------------------------------
+//  プログラム生成
+// ---------------------------------------------------------------
+
+// 散らすループの断片 (相対分岐は断片の中で閉じる)
+struct Snippet
+{
+  uint8_t len;
+  uint8_t code[12];
+};
+
+static const Snippet SNIPPETS[] = {
+  { 3, { 0xCA, 0xD0, 0xFD } },                         // DEX / BNE
+  { 4, { 0xEA, 0x88, 0xD0, 0xFC } },                   // NOP / DEY / BNE
+  { 5, { 0xEA, 0xEA, 0xE8, 0xD0, 0xFB } },             // NOP NOP / INX / BNE
+  { 3, { 0xC8, 0xD0, 0xFD } },                         // INY / BNE
+  { 9, { 0xA2, 0x00, 0xA9, 0x01, 0x80, 0x01,          // LDX #0 / LDA #1 / BRA +1
+         0xCA, 0xD0, 0xFD } },                         // DEX / BNE (X=0 で BNE から入る)
+  { 4, { 0xA5, 0x10, 0xF0, 0xFC } },                   // LDA $10 / BEQ (待機ループ)
+  { 5, { 0x2C, 0x00, 0x02, 0x10, 0xFB } },             // BIT $0200 / BPL
+  { 5, { 0xAD, 0x00, 0xE0, 0xF0, 0xFB } },             // LDA $E000 / BEQ (I/O なので省略しない)
+  { 3, { 0x4C, 0x00, 0x00 } },                         // JMP * (アドレスは置いた場所)
+  { 1, { 0xCB } },                                     // WAI
+  { 1, { 0x58 } },                                     // CLI
+};
+
+static void MakeProgram(uint32_t seed)
+{
+  g_rs = seed * 2654435761u + 1;
+  for (int i = 0; i < 0x10000; i++)
+  {
+    uint8_t b = (uint8_t)Rand();
+    // STP・WAI はほとんど NOP に置き換える (すぐ止まらないように)
+    if ((b == 0xDB || b == 0xCB) && (Rand() & 63)) b = 0xEA;
+    g_bus_a.mem[i] = b;
+  }
+  for (int i = 0; i < 512; i++)
+  {
+    const Snippet& s = SNIPPETS[Rand() % (sizeof(SNIPPETS) / sizeof(SNIPPETS[0]))];
+    uint16_t at = (uint16_t)Rand();
+    if (at > 0x10000 - 16) continue;
+    memcpy(&g_bus_a.mem[at], s.code, s.len);
+    if (s.code[0] == 0x4C) { g_bus_a.mem[at + 1] = at & 0xFF; g_bus_a.mem[at + 2] = at >> 8; }
+  }
+  g_bus_a.io_reads = 0;
+  memcpy(&g_bus_b, &g_bus_a, sizeof(TestBus));
+}
+
+// ---------------------------------------------------------------
+//  比較
+// ---------------------------------------------------------------
+static bool Same(const W65c02::State& a, const W65c02::State& b)
+{
+  return a.pc == b.pc && a.a == b.a && a.x == b.x && a.y == b.y && a.sp == b.sp && a.p == b.p &&
+         a.irq == b.irq && a.nmi == b.nmi && a.wai == b.wai && a.stp == b.stp;
+}
+
+static void Print(const char* name, const W65c02::State& c, uint64_t now)
+{
+  printf("  %s: cycle %llu pc=%04X a=%02X x=%02X y=%02X sp=%02X p=%02X irq=%d nmi=%d wai=%d stp=%d\n",
+         name, (unsigned long long)now, c.pc, c.a, c.x, c.y, c.sp, c.p, c.irq, c.nmi, c.wai, c.stp);
+}
+
+// 1つのプログラムを実行して比べる。一致すれば true
+static bool RunSeed(uint32_t seed, uint64_t cycles, uint64_t& skipped)
+{
+  MakeProgram(seed);
+  W65c02::State a, b;
+  W65c02::Reset(a, g_bus_a);
+  W65c02::Reset(b, g_bus_b);
+
+  uint64_t now_a = 0, now_b = 0;
+  while (now_a < cycles && !a.stp)
+  {
+    // 次のイベントとスライスの終わり (どちらが先に来るかも乱数)
+    uint64_t next_due = now_a + Rand() % 4000;
+    uint64_t target   = now_a + 1 + Rand() % 6000;
+    uint16_t pc       = a.pc;
+    W65c02::Run(a, g_bus_a, now_a, target, next_due);
+    while (now_b < now_a && !b.stp) now_b += W65c02::InstCycle(b, g_bus_b);
+
+    if (now_a != now_b || !Same(a, b) || g_bus_a.io_reads != g_bus_b.io_reads ||
+        memcmp(g_bus_a.mem, g_bus_b.mem, sizeof(g_bus_a.mem)) != 0)
+    {
+      printf("seed %u: Run と InstCycle が一致しない (スライス開始 pc=%04X, target=%llu, next_due=%llu)\n",
+             seed, pc, (unsigned long long)target, (unsigned long long)next_due);
+      Print("Run      ", a, now_a);
+      Print("InstCycle", b, now_b);
+      return false;
+    }
+
+    // イベント: IRQ 線の上げ下げ・NMI
+    uint32_t r = Rand();
+    if ((r & 3) == 0) a.irq = b.irq = !a.irq;
+    if ((r & 0x3F0) == 0) a.nmi = b.nmi = true;
+  }
+  skipped += a.idle_skipped + a.delay_skipped;
+  return true;
+}
+
+// ---------------------------------------------------------------
+//  メイン
+// ---------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  uint32_t seeds  = 300;
+  int64_t  only   = -1;
+  uint64_t cycles = 2000000;
+  for (int i = 1; i < argc; i++)
+  {
+    const char* eq = strchr(argv[i], '=');
+    if (!eq)
+    {
+      fprintf(stderr, "Error: 引数は key=value 形式で指定: %s\n", argv[i]);
+      return 2;
+    }
+    std::string key(argv[i], eq - argv[i]);
+    const char* val = eq + 1;
+    if      (key == "seeds")  seeds  = (uint32_t)strtoul(val, nullptr, 0);
+    else if (key == "seed")   only   = (int64_t)strtoul(val, nullptr, 0);
+    else if (key == "cycles") cycles = strtoull(val, nullptr, 0);
+    else
+    {
+      fprintf(stderr, "Error: 不明な引数: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  uint64_t skipped = 0;
+  uint32_t failed  = 0;
+  uint32_t first   = only >= 0 ? (uint32_t)only : 0;
+  uint32_t last    = only >= 0 ? (uint32_t)only + 1 : seeds;
+  for (uint32_t seed = first; seed < last; seed++)
+    if (!RunSeed(seed, cycles, skipped)) failed++;
+
+  printf("W65c02 Run/InstCycle: %u / %u programs differ (%llu cycles skipped by loop detection)\n",
+         failed, last - first, (unsigned long long)skipped);
+  return failed ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 #!/bin/bash
 
-# sampleコマンドを使った関数コール解析
+# sampleコマンドを使った関数コール解析 (macOS)
+# Linux では make PROF=1 でビルドし ./fxt65 prof=FILE を使う
 
 ./fxt65 2>/dev/null &
 A=$!
@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+"""tools/rom_aot.py - ROM イメージから事前変換コード (src/RomAot.hpp の実装) を生成
+
+リセット・IRQ・NMI ベクタから制御フローを辿り、到達できる命令ごとに
+W65c02::Execute<Bus, opcode> を呼ぶ C++ を出力する。
+命令表は src/W65c02.hpp の OPCODES から読むので、CPU コアと常に一致する。
+
+解析の範囲:
+  - 分岐・BBR/BBS は両方向、JSR は飛び先と戻り先、BRK は戻り先 (pc+2) を辿る
+  - JMP ($xxxx) はポインタが ROM 内にあれば飛び先を辿る
+  - JMP ($xxxx,X)・RTS・RTI の行き先は実行時に PC で表引きする
+  - ROM からはみ出す命令と1サイクルNOP (未定義命令) は変換しない (インタプリタが実行)
+  - 後方への分岐・JMP $xxxx の後では W65c02::OnLoopBranch で待機ループ・遅延ループを調べる
+
+Usage:
+  python3 tools/rom_aot.py <rom.bin> <RomAot.cpp>
+"""
+
+import os
+import re
+import sys
+
+
+ROM_BASE = 0xF000
+ROM_SIZE = 0x1000
+CORE_HEADER = os.path.join(os.path.dirname(__file__), "..", "src", "W65c02.hpp")
+
+# ベクタ
+VECTORS = {"NMI": 0xFFFA, "RESET": 0xFFFC, "IRQ": 0xFFFE}
+
+# 命令長 (アドレッシングモード別)
+MODE_LENGTH = {
+    "IMP": 1, "ACC": 1,
+    "IMM": 2, "ZP": 2, "ZPX": 2, "ZPY": 2, "ZPI": 2, "XIN": 2, "YIN": 2, "YIP": 2, "REL": 2,
+    "AB": 3, "ABX": 3, "ABY": 3, "AXP": 3, "AYP": 3, "IND": 3, "INDX": 3,
+}
+
+# 条件分岐
+BRANCHES = {"BPL", "BMI", "BVC", "BVS", "BCC", "BCS", "BNE", "BEQ", "BBR", "BBS"}
+
+
+def load_opcodes(path: str) -> list:
+    """W65c02.hpp の OPCODES 表を (op, mode, cycles) のリストで返す"""
+    with open(path, encoding="utf-8") as f:
+        src = f.read()
+    body = src[src.index("OPCODES[256]"):]
+    body = body[:body.index("};")]
+    table = [(op, mode, int(cyc)) for op, mode, cyc in
+             re.findall(r"\{(\w+),\s*(\w+),\s*(\d+)\}", body)]
+    if len(table) != 256:
+        raise ValueError(f"OPCODES の読み取りに失敗しました ({len(table)} 件)")
+    return table
+
+
+def load_rom(path: str) -> bytes:
+    """8KB イメージなら後半 4KB (LoadRom と同じ)、4KB ならそのまま"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) == 2 * ROM_SIZE:
+        return data[ROM_SIZE:]
+    if len(data) == ROM_SIZE:
+        return data
+    raise ValueError(f"ROM サイズが不正です: {len(data)} バイト")
+
+
+class Insn:
+    def __init__(self, addr, opc, op, mode, length):
+        self.addr   = addr
+        self.opc    = opc
+        self.op     = op
+        self.mode   = mode
+        self.length = length
+        self.target = None   # 静的に決まる飛び先
+        self.falls  = True   # 次の命令へ進み得るか
+        self.dynamic = False # 飛び先を実行時に表引きするか
+
+
+def in_rom(addr: int) -> bool:
+    return ROM_BASE <= addr <= 0xFFFF
+
+
+def analyse(rom: bytes, table: list) -> dict:
+    """到達できる命令を辿って {addr: Insn} を返す"""
+    def byte(addr):
+        return rom[addr - ROM_BASE]
+
+    def word(addr):
+        return byte(addr) | (byte(addr + 1) << 8)
+
+    insns = {}
+    work = [word(v) for v in VECTORS.values()]
+    while work:
+        addr = work.pop()
+        if addr in insns or not in_rom(addr):
+            continue
+        opc = byte(addr)
+        op, mode, cycles = table[opc]
+        length = 3 if op in ("BBR", "BBS") else MODE_LENGTH[mode]
+        # ROM からはみ出す命令・未定義命令は変換しない
+        if addr + length - 1 > 0xFFFF or (op == "NOP" and cycles == 1):
+            continue
+
+        insn = Insn(addr, opc, op, mode, length)
+        insns[addr] = insn
+        nxt = addr + length
+
+        if op in BRANCHES or op == "BRA":
+            rel = byte(addr + length - 1)
+            insn.target = (nxt + (rel - 256 if rel & 0x80 else rel)) & 0xFFFF
+            insn.falls  = op != "BRA"
+        elif op == "JMP" and mode == "AB":
+            insn.target = word(addr + 1)
+            insn.falls  = False
+        elif op == "JMP" and mode == "IND":
+            ptr = word(addr + 1)
+            if in_rom(ptr) and in_rom(ptr + 1):
+                work.append(word(ptr))
+            insn.dynamic = True
+            insn.falls   = False
+        elif op == "JSR":
+            insn.target = word(addr + 1)
+        elif op == "BRK":
+            work.append((addr + 2) & 0xFFFF)
+            insn.dynamic = True
+            insn.falls   = False
+        elif op in ("RTS", "RTI") or (op == "JMP" and mode == "INDX"):
+            insn.dynamic = True
+            insn.falls   = False
+        elif op == "STP":
+            insn.falls = False
+
+        if insn.target is not None:
+            work.append(insn.target)
+        if insn.falls:
+            work.append(nxt)
+    return insns
+
+
+def generate(rom: bytes, table: list, insns: dict, rom_path: str) -> str:
+    out = []
+    w = out.append
+
+    used_dispatch = False  # 本体から goto dispatch するか (しなければラベルを出さない)
+
+    def go(addr):
+        nonlocal used_dispatch
+        if addr in insns:
+            return f"goto L_{addr:04X};"
+        used_dispatch = True
+        return "goto dispatch;"
+
+    w(f"/* RomAot.cpp - tools/rom_aot.py が {os.path.basename(rom_path)} から生成 (編集しないこと) */")
+    w('#include "RomAot.hpp"')
+    w('#include "Cpu.hpp"')
+    w("")
+    w("#include <cstring>")
+    w("")
+    w("namespace Fxt")
+    w("{")
+    w("namespace RomAot")
+    w("{")
+    w("  // 生成元の ROM イメージ")
+    w(f"  static const uint8_t IMAGE[0x{ROM_SIZE:X}] = {{")
+    for i in range(0, ROM_SIZE, 16):
+        w("    " + ", ".join(f"0x{b:02X}" for b in rom[i:i + 16]) + ",")
+    w("  };")
+    w("")
+    w("  // ROM 読み出しを定数表から行うバス (オペランドがコンパイル時に畳み込まれる)")
+    w("  struct Bus : Cpu::Bus")
+    w("  {")
+    w("    explicit Bus(System& s) : Cpu::Bus{s} {}")
+    w("")
+    w("    uint8_t Read(uint16_t addr)")
+    w("    {")
+    w("      if (addr >= 0xF000) return IMAGE[addr & 0x0FFF];")
+    w("      return Cpu::Bus::Read(addr);")
+    w("    }")
+    w("")
+    w("    uint8_t Fetch(uint16_t addr) { return Read(addr); }")
+    w("  };")
+    w("")
+    w("  // 命令境界での停止条件 (W65c02::Run と同じ。マスクされた IRQ では止まらない)")
+    w("  static inline bool Stop(const W65c02::State& cpu, uint64_t now, uint64_t target, uint64_t next_due)")
+    w("  {")
+    w("    return now >= target || now > next_due || (cpu.stp | cpu.wai | cpu.nmi) ||")
+    w("           (cpu.irq && !(cpu.p & W65c02::FLAG_I));")
+    w("  }")
+    w("")
+    w("  bool Matches(const System& sys)")
+    w("  {")
+    w("    return memcmp(sys.rom, IMAGE, sizeof(IMAGE)) == 0;")
+    w("  }")
+    w("")
+    w("  // 1命令: 実行して停止条件を見る")
+    w("#define FXT_AOT_INSN(addr, opc)                                 \\")
+    w("  L_##addr:                                                     \\")
+    w("    cpu.opcode_addr = 0x##addr;                                 \\")
+    w("    cpu.pc          = 0x##addr + 1;                             \\")
+    w("    cpu.opcode      = opc;                                      \\")
+    w("    now += W65c02::Execute<Bus, opc>(cpu, bus);                 \\")
+    w("    ran = true;                                                 \\")
+    w("    if (Stop(cpu, now, target, next_due)) return true;")
+    w("")
+    w("  bool Run(System& sys, uint64_t target)")
+    w("  {")
+    w("    W65c02::State&  cpu      = sys.cpu;")
+    w("    uint64_t&       now      = sys.sched.now;")
+    w("    const uint64_t& next_due = sys.sched.next_due;")
+    w("    Bus             bus(sys);")
+    w("    bool            ran = false;")
+    w("    W65c02::IdleLoop loop;")
+    w("")
+    w("    if (cpu.step | cpu.stp | cpu.wai | cpu.nmi) return false;")
+    w("    if (cpu.irq && !(cpu.p & W65c02::FLAG_I)) return false;")
+    if not insns:
+        # 変換できた命令がない ROM では now / next_due を参照しない
+        w("    (void)now;")
+        w("    (void)next_due;")
+    w("")
+    dispatch_at = len(out)
+    w("    switch (cpu.pc)")
+    w("    {")
+    addrs = sorted(insns)
+    for i in range(0, len(addrs), 4):
+        w("      " + " ".join(f"case 0x{a:04X}: goto L_{a:04X};" for a in addrs[i:i + 4]))
+    w("      default: return ran;")
+    w("    }")
+    w("")
+
+    for i, addr in enumerate(addrs):
+        insn = insns[addr]
+        nxt  = addr + insn.length
+        following = addrs[i + 1] if i + 1 < len(addrs) else None
+        w(f"    FXT_AOT_INSN({addr:04X}, 0x{insn.opc:02X}) // {insn.op} {insn.mode}")
+        if insn.target is not None and insn.target <= addr and insn.op != "JSR":
+            w("    W65c02::OnLoopBranch(loop, cpu, bus, now, target, next_due);")
+        if insn.op == "STP":
+            w("    return true;")
+        elif insn.dynamic:
+            used_dispatch = True
+            w("    goto dispatch;")
+        elif insn.target is not None and insn.falls:
+            if insn.op == "JSR":
+                w(f"    {go(insn.target)}")
+            else:
+                w(f"    if (cpu.pc == 0x{insn.target:04X}) {go(insn.target)}")
+                if following != nxt:
+                    w(f"    {go(nxt & 0xFFFF)}")
+        elif insn.target is not None:
+            w(f"    {go(insn.target)}")
+        elif following != nxt:
+            w(f"    {go(nxt & 0xFFFF)}")
+    if used_dispatch:
+        out.insert(dispatch_at, "  dispatch:")
+    w("  }")
+    w("")
+    w("#undef FXT_AOT_INSN")
+    w("")
+    w("}")
+    w("}")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    rom_path, out_path = sys.argv[1], sys.argv[2]
+
+    table = load_opcodes(CORE_HEADER)
+    rom   = load_rom(rom_path)
+    insns = analyse(rom, table)
+
+    os.makedirs(os.path.dirname(out_path) or ".", exist_ok=True)
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(generate(rom, table, insns, rom_path))
+    print(f"{out_path}: {len(insns)} 命令を変換")
+
+
+if __name__ == "__main__":
+    main()